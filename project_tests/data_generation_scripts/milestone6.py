@@ -0,0 +1,1009 @@
+#!/usr/bin/python
+import sys, string
+from random import choice
+import random
+from string import ascii_lowercase
+from scipy.stats import beta, uniform
+import numpy as np
+import struct
+import pandas as pd
+import math
+
+import data_gen_utils
+
+# note this is the base path to the data files we generate
+TEST_BASE_DIR = "/cs165/generated_data"
+
+# note this is the base path that _POINTS_ to the data files we generate
+DOCKER_TEST_BASE_DIR = "/cs165/staff_test"
+
+#
+# Example usage:
+#   python milestone6.py 10000 42 ~/repo/cs165-docker-test-runner/test_data /cs165/staff_test
+#
+
+############################################################################
+# Notes: Correctness tests for the operators added on top of the milestones:
+# group by, multi-predicate selects, position sets, fused aggregates,
+# scalar arithmetic and multi-column fetches.
+############################################################################
+
+# PRECISION FOR AVG OPERATION
+PLACES_TO_ROUND = 2
+
+# keys drawn from this many values give more distinct keys within one morsel than
+# fit the per-morsel group tables, so group_by partitions them (tables >= 10000 rows)
+MANY_GROUPS = 8192
+
+# rows per morsel on the server; the sorted group by table spans several of them
+MORSEL_SIZE = 65536
+SORTED_TABLE_SIZE = 2 * MORSEL_SIZE + 20000
+# runs of at least this many equal keys are aggregated by the vector kernels
+RUN_KERNEL_MIN = 64
+
+# the filter table has several zones of ZONE_SIZE rows per morsel
+ZONE_SIZE = 4096
+FILTER_TABLE_SIZE = 100000
+
+# values of the wide table are large enough that sums of two of them leave the INT range
+WIDE_VALUE_LOW = 1100000000
+WIDE_VALUE_HIGH = 2000000000
+
+# the radix join partitions until a partition holds ~5000 build rows (RADIX_PARTITION_BYTES over
+# the bytes per build row), 7 bits per pass: more than 2^7 such partitions take a second pass
+JOIN_TABLE_SIZE = 700000
+# every key appears about JOIN_TABLE_SIZE / JOIN_KEYS times on each side
+JOIN_KEYS = 100000
+# a side of at most this many rows is hashed whole instead of radix partitioned
+JOIN_CACHE_ROWS = 1000
+
+# the range table holds runs of RANGE_RUN_ROWS equal keys, shuffled within groups of RANGE_RUN_GROUP runs:
+# an index select of a few keys is a handful of runs, which the server keeps range encoded
+RANGE_RUN_ROWS = 64
+RANGE_RUN_GROUP = 8
+RANGE_TABLE_SIZE = RANGE_RUN_ROWS * RANGE_RUN_GROUP * 40
+
+def generateDataGroupBy(dataSize):
+    outputFile = TEST_BASE_DIR + '/data6.csv'
+    header_line = data_gen_utils.generateHeaderLine('db1', 'tbl6', 4)
+    outputTable = pd.DataFrame(np.random.randint(0, 100, size=(dataSize, 4)), columns =['col1', 'col2', 'col3', 'col4'])
+    # few groups
+    outputTable['col1'] = np.random.randint(0, 10, size = (dataSize))
+    # many groups
+    outputTable['col2'] = np.random.randint(0, MANY_GROUPS, size = (dataSize))
+    outputTable['col3'] = np.random.randint(-1000, 1000, size = (dataSize))
+    outputTable.to_csv(outputFile, sep=',', index=False, header=header_line)
+    return outputTable
+
+def generateDataSortedGroupBy():
+    outputFile = TEST_BASE_DIR + '/data7.csv'
+    header_line = data_gen_utils.generateHeaderLine('db1', 'tbl7', 2)
+    # ascending keys in runs, a mix of runs shorter and longer than RUN_KERNEL_MIN
+    runLengths = np.where(np.random.uniform(0.0, 1.0, SORTED_TABLE_SIZE) < 0.5,
+        np.random.randint(1, RUN_KERNEL_MIN, size = (SORTED_TABLE_SIZE)),
+        np.random.randint(RUN_KERNEL_MIN, 4 * RUN_KERNEL_MIN, size = (SORTED_TABLE_SIZE)))
+    keys = np.repeat(np.arange(SORTED_TABLE_SIZE) * 3 - 10000, runLengths)[:SORTED_TABLE_SIZE]
+    # make one long run straddle every morsel boundary
+    for boundary in range(MORSEL_SIZE, SORTED_TABLE_SIZE, MORSEL_SIZE):
+        keys[boundary - 500:boundary + 500] = keys[boundary - 500]
+    outputTable = pd.DataFrame({'col1': keys, 'col2': np.random.randint(-1000, 1000, size = (SORTED_TABLE_SIZE))})
+    outputTable.to_csv(outputFile, sep=',', index=False, header=header_line)
+    return outputTable
+
+def generateDataFilter():
+    outputFile = TEST_BASE_DIR + '/data8.csv'
+    header_line = data_gen_utils.generateHeaderLine('db1', 'tbl8', 4)
+    outputTable = pd.DataFrame(np.random.randint(0, 1000, size=(FILTER_TABLE_SIZE, 4)), columns =['col1', 'col2', 'col3', 'col4'])
+    # col1 is the row position, so fetching it prints the positions of a select
+    outputTable['col1'] = np.arange(FILTER_TABLE_SIZE)
+    # col2 is clustered, every zone holds a narrow range of it
+    outputTable['col2'] = (outputTable['col1'] // 1000) * 10 + np.random.randint(0, 10, size = (FILTER_TABLE_SIZE))
+    outputTable['col4'] = np.random.randint(-500, 500, size = (FILTER_TABLE_SIZE))
+    outputTable.to_csv(outputFile, sep=',', index=False, header=header_line)
+    return outputTable
+
+def generateDataSortedIndex(dataSize):
+    outputFile = TEST_BASE_DIR + '/data9.csv'
+    header_line = data_gen_utils.generateHeaderLine('db1', 'tbl9', 3)
+    outputTable = pd.DataFrame(np.random.randint(0, 1000, size=(dataSize, 3)), columns =['col1', 'col2', 'col3'])
+    outputTable['col3'] = np.random.randint(-1000, 1000, size = (dataSize))
+    outputTable.to_csv(outputFile, sep=',', index=False, header=header_line)
+    return outputTable
+
+def generateDataWide():
+    outputFile = TEST_BASE_DIR + '/data10.csv'
+    header_line = data_gen_utils.generateHeaderLine('db1', 'tbl10', 4)
+    outputTable = pd.DataFrame(np.random.randint(0, 1000, size=(FILTER_TABLE_SIZE, 4)), columns =['col1', 'col2', 'col3', 'col4'])
+    outputTable['col2'] = np.random.randint(WIDE_VALUE_LOW, WIDE_VALUE_HIGH, size = (FILTER_TABLE_SIZE))
+    outputTable['col3'] = np.random.randint(WIDE_VALUE_LOW, WIDE_VALUE_HIGH, size = (FILTER_TABLE_SIZE))
+    outputTable['col4'] = np.random.randint(-WIDE_VALUE_HIGH, -WIDE_VALUE_LOW, size = (FILTER_TABLE_SIZE))
+    outputTable.to_csv(outputFile, sep=',', index=False, header=header_line)
+    return outputTable
+
+def generateDataJoin():
+    outputFile = TEST_BASE_DIR + '/data11.csv'
+    header_line = data_gen_utils.generateHeaderLine('db1', 'tbl11', 2)
+    outputTable = pd.DataFrame(np.random.randint(0, JOIN_KEYS, size=(JOIN_TABLE_SIZE, 2)), columns =['col1', 'col2'])
+    outputTable.to_csv(outputFile, sep=',', index=False, header=header_line)
+    return outputTable
+
+def generateDataRanges():
+    outputFile = TEST_BASE_DIR + '/data12.csv'
+    header_line = data_gen_utils.generateHeaderLine('db1', 'tbl12', 3)
+    outputTable = pd.DataFrame(np.random.randint(-1000, 1000, size=(RANGE_TABLE_SIZE, 3)), columns =['col1', 'col2', 'col3'])
+    # col1 is the row position, so fetching it prints the positions of a select
+    outputTable['col1'] = np.arange(RANGE_TABLE_SIZE)
+    runs = RANGE_TABLE_SIZE // RANGE_RUN_ROWS
+    keys = np.concatenate([np.random.permutation(np.arange(start, start + RANGE_RUN_GROUP)) for start in range(0, runs, RANGE_RUN_GROUP)])
+    outputTable['col2'] = np.repeat(keys, RANGE_RUN_ROWS)
+    outputTable.to_csv(outputFile, sep=',', index=False, header=header_line)
+    return outputTable
+
+def writeGroups(exp_output_file, keys, aggregates, isAverage):
+    for key, aggregate in zip(keys, aggregates):
+        if isAverage:
+            exp_output_file.write('{},{:0.2f}\n'.format(key, aggregate))
+        else:
+            exp_output_file.write('{},{}\n'.format(key, aggregate))
+
+def createTest44():
+    output_file, exp_output_file = data_gen_utils.openFileHandles(44, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Load the group by table tbl6\n')
+    output_file.write('--\n')
+    output_file.write('-- col1 has few distinct values, col2 has more than fit the per-morsel group tables\n')
+    output_file.write('create(tbl,"tbl6",db1,4)\n')
+    output_file.write('create(col,"col1",db1.tbl6)\n')
+    output_file.write('create(col,"col2",db1.tbl6)\n')
+    output_file.write('create(col,"col3",db1.tbl6)\n')
+    output_file.write('create(col,"col4",db1.tbl6)\n')
+    output_file.write('load(\"'+DOCKER_TEST_BASE_DIR+'/data6.csv\")\n')
+    output_file.write('shutdown\n')
+    # no expected results
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest45(dataTable, approxSelectivity):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(45, TEST_DIR=TEST_BASE_DIR)
+    selectValLess = np.random.randint(0, int(100 * (1 - approxSelectivity)))
+    selectValGreater = selectValLess + int(100 * approxSelectivity)
+    output_file.write('-- Correctness test: group by over columns and intermediates\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, sum(col3) FROM tbl6 GROUP BY col1;\n')
+    output_file.write('k1,a1=group_by(db1.tbl6.col1,db1.tbl6.col3,sum)\n')
+    output_file.write('print(k1,a1)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, avg(col3) FROM tbl6 GROUP BY col1;\n')
+    output_file.write('k2,a2=group_by(db1.tbl6.col1,db1.tbl6.col3,avg)\n')
+    output_file.write('print(k2,a2)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col2, min(col3) FROM tbl6 GROUP BY col2;\n')
+    output_file.write('k3,a3=group_by(db1.tbl6.col2,db1.tbl6.col3,min)\n')
+    output_file.write('print(k3,a3)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col2, max(col3) FROM tbl6 GROUP BY col2;\n')
+    output_file.write('k4,a4=group_by(db1.tbl6.col2,db1.tbl6.col3,max)\n')
+    output_file.write('print(k4,a4)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, max(col3) FROM tbl6 WHERE col4 >= {} AND col4 < {} GROUP BY col1;\n'.format(selectValLess, selectValGreater))
+    output_file.write('s1=select(db1.tbl6.col4,{},{})\n'.format(selectValLess, selectValGreater))
+    output_file.write('f1=fetch(db1.tbl6.col1,s1)\n')
+    output_file.write('f2=fetch(db1.tbl6.col2,s1)\n')
+    output_file.write('f3=fetch(db1.tbl6.col3,s1)\n')
+    output_file.write('k5,a5=group_by(f1,f3,max)\n')
+    output_file.write('print(k5,a5)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col2, sum(col3) FROM tbl6 WHERE col4 >= {} AND col4 < {} GROUP BY col2;\n'.format(selectValLess, selectValGreater))
+    output_file.write('k6,a6=group_by(f2,f3,sum)\n')
+    output_file.write('print(k6,a6)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col2, avg(col3) FROM tbl6 WHERE col4 >= {} AND col4 < {} GROUP BY col2;\n'.format(selectValLess, selectValGreater))
+    output_file.write('k7,a7=group_by(f2,f3,avg)\n')
+    output_file.write('print(k7,a7)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, min(col3) FROM tbl6 WHERE col4 >= {} AND col4 < {} GROUP BY col1;\n'.format(selectValLess, selectValGreater))
+    output_file.write('k8,a8=group_by(f1,f3,min)\n')
+    output_file.write('print(k8,a8)\n')
+    # generate expected results
+    groups = dataTable.groupby('col1')['col3']
+    writeGroups(exp_output_file, groups.sum().index, groups.sum(), False)
+    writeGroups(exp_output_file, groups.mean().index, groups.mean(), True)
+    groups = dataTable.groupby('col2')['col3']
+    writeGroups(exp_output_file, groups.min().index, groups.min(), False)
+    writeGroups(exp_output_file, groups.max().index, groups.max(), False)
+    dfSelectMask = (dataTable['col4'] >= selectValLess) & (dataTable['col4'] < selectValGreater)
+    selected = dataTable[dfSelectMask]
+    groups = selected.groupby('col1')['col3']
+    writeGroups(exp_output_file, groups.max().index, groups.max(), False)
+    groups = selected.groupby('col2')['col3']
+    writeGroups(exp_output_file, groups.sum().index, groups.sum(), False)
+    writeGroups(exp_output_file, groups.mean().index, groups.mean(), True)
+    groups = selected.groupby('col1')['col3']
+    writeGroups(exp_output_file, groups.min().index, groups.min(), False)
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest46():
+    output_file, exp_output_file = data_gen_utils.openFileHandles(46, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Load the sorted group by table tbl7\n')
+    output_file.write('--\n')
+    output_file.write('-- col1 is ascending in runs of equal keys and longer than one morsel,\n')
+    output_file.write('-- with a run crossing every morsel boundary\n')
+    output_file.write('create(tbl,"tbl7",db1,2)\n')
+    output_file.write('create(col,"col1",db1.tbl7)\n')
+    output_file.write('create(col,"col2",db1.tbl7)\n')
+    output_file.write('load(\"'+DOCKER_TEST_BASE_DIR+'/data7.csv\")\n')
+    output_file.write('shutdown\n')
+    # no expected results
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest47(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(47, TEST_DIR=TEST_BASE_DIR)
+    # a key range around the first morsel boundary
+    selectValLess = int(dataTable['col1'][MORSEL_SIZE - 20000])
+    selectValGreater = int(dataTable['col1'][MORSEL_SIZE + 20000])
+    output_file.write('-- Correctness test: group by sorted keys, runs crossing morsel boundaries\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, sum(col2) FROM tbl7 GROUP BY col1;\n')
+    output_file.write('k1,a1=group_by(db1.tbl7.col1,db1.tbl7.col2,sum)\n')
+    output_file.write('print(k1,a1)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, avg(col2) FROM tbl7 GROUP BY col1;\n')
+    output_file.write('k2,a2=group_by(db1.tbl7.col1,db1.tbl7.col2,avg)\n')
+    output_file.write('print(k2,a2)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, min(col2) FROM tbl7 GROUP BY col1;\n')
+    output_file.write('k3,a3=group_by(db1.tbl7.col1,db1.tbl7.col2,min)\n')
+    output_file.write('print(k3,a3)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, max(col2) FROM tbl7 GROUP BY col1;\n')
+    output_file.write('k4,a4=group_by(db1.tbl7.col1,db1.tbl7.col2,max)\n')
+    output_file.write('print(k4,a4)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, sum(col2) FROM tbl7 WHERE col1 >= {} AND col1 < {} GROUP BY col1;\n'.format(selectValLess, selectValGreater))
+    output_file.write('s1=select(db1.tbl7.col1,{},{})\n'.format(selectValLess, selectValGreater))
+    output_file.write('f1=fetch(db1.tbl7.col1,s1)\n')
+    output_file.write('f2=fetch(db1.tbl7.col2,s1)\n')
+    output_file.write('k5,a5=group_by(f1,f2,sum)\n')
+    output_file.write('print(k5,a5)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, max(col2) FROM tbl7 WHERE col1 >= {} AND col1 < {} GROUP BY col1;\n'.format(selectValLess, selectValGreater))
+    output_file.write('k6,a6=group_by(f1,f2,max)\n')
+    output_file.write('print(k6,a6)\n')
+    # generate expected results
+    groups = dataTable.groupby('col1')['col2']
+    writeGroups(exp_output_file, groups.sum().index, groups.sum(), False)
+    writeGroups(exp_output_file, groups.mean().index, groups.mean(), True)
+    writeGroups(exp_output_file, groups.min().index, groups.min(), False)
+    writeGroups(exp_output_file, groups.max().index, groups.max(), False)
+    dfSelectMask = (dataTable['col1'] >= selectValLess) & (dataTable['col1'] < selectValGreater)
+    groups = dataTable[dfSelectMask].groupby('col1')['col2']
+    writeGroups(exp_output_file, groups.sum().index, groups.sum(), False)
+    writeGroups(exp_output_file, groups.max().index, groups.max(), False)
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest48():
+    output_file, exp_output_file = data_gen_utils.openFileHandles(48, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Load the filter table tbl8\n')
+    output_file.write('--\n')
+    output_file.write('-- col1 is the row position, col2 is clustered, col3 and col4 are uniform\n')
+    output_file.write('create(tbl,"tbl8",db1,4)\n')
+    output_file.write('create(col,"col1",db1.tbl8)\n')
+    output_file.write('create(col,"col2",db1.tbl8)\n')
+    output_file.write('create(col,"col3",db1.tbl8)\n')
+    output_file.write('create(col,"col4",db1.tbl8)\n')
+    output_file.write('load(\"'+DOCKER_TEST_BASE_DIR+'/data8.csv\")\n')
+    output_file.write('shutdown\n')
+    # no expected results
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def writePositions(exp_output_file, dataTable, mask):
+    exp_output_file.write(str(int(mask.sum())) + '\n')
+    output = dataTable[mask]['col1']
+    if len(output) > 0:
+        exp_output_file.write(data_gen_utils.outputPrint(output))
+        exp_output_file.write('\n')
+
+def createTest49(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(49, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: multi-predicate and/or selects\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE col2 >= 300 AND col2 < 500 AND col3 >= 0 AND col3 < 100;\n')
+    output_file.write('s1=select(and(db1.tbl8.col2,300,500),(db1.tbl8.col3,0,100))\n')
+    output_file.write('c1=count(s1)\n')
+    output_file.write('f1=fetch(db1.tbl8.col1,s1)\n')
+    output_file.write('print(c1)\n')
+    output_file.write('print(f1)\n')
+    output_file.write('--\n')
+    output_file.write('-- The same as a chain of selects and fetches\n')
+    output_file.write('s2=select(db1.tbl8.col2,300,500)\n')
+    output_file.write('f2=fetch(db1.tbl8.col3,s2)\n')
+    output_file.write('s3=select(s2,f2,0,100)\n')
+    output_file.write('c3=count(s3)\n')
+    output_file.write('f3=fetch(db1.tbl8.col1,s3)\n')
+    output_file.write('print(c3)\n')
+    output_file.write('print(f3)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE col3 >= 500 AND col3 < 510 AND col1 >= 50000 AND col2 < 800;\n')
+    output_file.write('s4=select(and(db1.tbl8.col3,500,510),(db1.tbl8.col1,50000,null),(db1.tbl8.col2,null,800))\n')
+    output_file.write('c4=count(s4)\n')
+    output_file.write('f4=fetch(db1.tbl8.col1,s4)\n')
+    output_file.write('print(c4)\n')
+    output_file.write('print(f4)\n')
+    output_file.write('--\n')
+    output_file.write('-- Zones are either taken whole for col1, scanned, or skipped for both predicates\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE col1 < 10000 OR (col2 >= 600 AND col2 < 700);\n')
+    output_file.write('s5=select(or(db1.tbl8.col1,null,10000),(db1.tbl8.col2,600,700))\n')
+    output_file.write('c5=count(s5)\n')
+    output_file.write('f5=fetch(db1.tbl8.col1,s5)\n')
+    output_file.write('print(c5)\n')
+    output_file.write('print(f5)\n')
+    output_file.write('--\n')
+    output_file.write('-- No zone can be skipped for the uniform col3\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE (col3 >= 0 AND col3 < 20) OR col1 >= 95000;\n')
+    output_file.write('s6=select(or(db1.tbl8.col3,0,20),(db1.tbl8.col1,95000,null))\n')
+    output_file.write('c6=count(s6)\n')
+    output_file.write('f6=fetch(db1.tbl8.col1,s6)\n')
+    output_file.write('print(c6)\n')
+    output_file.write('print(f6)\n')
+    # generate expected results
+    mask = (dataTable['col2'] >= 300) & (dataTable['col2'] < 500) & (dataTable['col3'] >= 0) & (dataTable['col3'] < 100)
+    writePositions(exp_output_file, dataTable, mask)
+    writePositions(exp_output_file, dataTable, mask)
+    mask = (dataTable['col3'] >= 500) & (dataTable['col3'] < 510) & (dataTable['col1'] >= 50000) & (dataTable['col2'] < 800)
+    writePositions(exp_output_file, dataTable, mask)
+    mask = (dataTable['col1'] < 10000) | ((dataTable['col2'] >= 600) & (dataTable['col2'] < 700))
+    writePositions(exp_output_file, dataTable, mask)
+    mask = ((dataTable['col3'] >= 0) & (dataTable['col3'] < 20)) | (dataTable['col1'] >= 95000)
+    writePositions(exp_output_file, dataTable, mask)
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def writePositionSums(exp_output_file, dataTable, mask):
+    exp_output_file.write('{},{},{}\n'.format(int(mask.sum()), int(dataTable[mask]['col1'].sum()), int(dataTable[mask]['col3'].sum())))
+
+def createTest50(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(50, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: and/or of position sets\n')
+    output_file.write('--\n')
+    output_file.write('-- s1 and s2 select enough rows to be bitmaps, s3 and s4 few enough to be position lists\n')
+    output_file.write('s1=select(db1.tbl8.col3,0,500)\n')
+    output_file.write('s2=select(db1.tbl8.col4,-100,null)\n')
+    output_file.write('s3=select(db1.tbl8.col2,100,130)\n')
+    output_file.write('s4=select(db1.tbl8.col3,990,null)\n')
+    output_file.write('--\n')
+    output_file.write('-- Prints the count, the sum of the positions and the sum of col3 of every set\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE (col3 >= 0 AND col3 < 500) AND col4 >= -100;\n')
+    output_file.write('a1=and(s1,s2)\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE (col3 >= 0 AND col3 < 500) OR col4 >= -100;\n')
+    output_file.write('o1=or(s1,s2)\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE (col3 >= 0 AND col3 < 500) OR (col2 >= 100 AND col2 < 130);\n')
+    output_file.write('o2=or(s3,s1)\n')
+    for name in ['a1', 'o1', 'o2']:
+        output_file.write('c{}=count({})\n'.format(name, name))
+        output_file.write('p{}=fetch(db1.tbl8.col1,{})\n'.format(name, name))
+        output_file.write('v{}=fetch(db1.tbl8.col3,{})\n'.format(name, name))
+        output_file.write('sp{}=sum(p{})\n'.format(name, name))
+        output_file.write('sv{}=sum(v{})\n'.format(name, name))
+        output_file.write('print(c{},sp{},sv{})\n'.format(name, name, name))
+    output_file.write('--\n')
+    output_file.write('-- Prints the count and the positions of every set\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE (col3 >= 0 AND col3 < 500) AND (col2 >= 100 AND col2 < 130);\n')
+    output_file.write('a2=and(s1,s3)\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE (col2 >= 100 AND col2 < 130) AND col3 >= 990;\n')
+    output_file.write('a3=and(s3,s4)\n')
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE (col2 >= 100 AND col2 < 130) OR col3 >= 990;\n')
+    output_file.write('o3=or(s4,s3)\n')
+    for name in ['a2', 'a3', 'o3']:
+        output_file.write('c{}=count({})\n'.format(name, name))
+        output_file.write('p{}=fetch(db1.tbl8.col1,{})\n'.format(name, name))
+        output_file.write('print(c{})\n'.format(name))
+        output_file.write('print(p{})\n'.format(name))
+    output_file.write('--\n')
+    output_file.write('-- Bitmaps over different numbers of rows: s5 is taken before an insert, s6 after it\n')
+    output_file.write('-- INSERT INTO tbl8 VALUES ({},1000,250,0);\n'.format(FILTER_TABLE_SIZE))
+    output_file.write('s5=select(db1.tbl8.col3,0,500)\n')
+    output_file.write('relational_insert(db1.tbl8,{},1000,250,0)\n'.format(FILTER_TABLE_SIZE))
+    output_file.write('s6=select(db1.tbl8.col4,-100,null)\n')
+    output_file.write('a4=and(s5,s6)\n')
+    output_file.write('o4=or(s5,s6)\n')
+    for name in ['a4', 'o4']:
+        output_file.write('c{}=count({})\n'.format(name, name))
+        output_file.write('p{}=fetch(db1.tbl8.col1,{})\n'.format(name, name))
+        output_file.write('v{}=fetch(db1.tbl8.col3,{})\n'.format(name, name))
+        output_file.write('sp{}=sum(p{})\n'.format(name, name))
+        output_file.write('sv{}=sum(v{})\n'.format(name, name))
+        output_file.write('print(c{},sp{},sv{})\n'.format(name, name, name))
+    # the insert is kept for the following tests
+    output_file.write('shutdown\n')
+    # generate expected results
+    mask1 = (dataTable['col3'] >= 0) & (dataTable['col3'] < 500)
+    mask2 = dataTable['col4'] >= -100
+    mask3 = (dataTable['col2'] >= 100) & (dataTable['col2'] < 130)
+    mask4 = dataTable['col3'] >= 990
+    writePositionSums(exp_output_file, dataTable, mask1 & mask2)
+    writePositionSums(exp_output_file, dataTable, mask1 | mask2)
+    writePositionSums(exp_output_file, dataTable, mask3 | mask1)
+    writePositions(exp_output_file, dataTable, mask1 & mask3)
+    writePositions(exp_output_file, dataTable, mask3 & mask4)
+    writePositions(exp_output_file, dataTable, mask4 | mask3)
+    dataTable = pd.concat([dataTable, pd.DataFrame([[FILTER_TABLE_SIZE, 1000, 250, 0]], columns=['col1', 'col2', 'col3', 'col4'])], ignore_index = True)
+    # the inserted row is not in s5
+    mask5 = (dataTable['col3'] >= 0) & (dataTable['col3'] < 500) & (dataTable['col1'] < FILTER_TABLE_SIZE)
+    mask6 = dataTable['col4'] >= -100
+    writePositionSums(exp_output_file, dataTable, mask5 & mask6)
+    writePositionSums(exp_output_file, dataTable, mask5 | mask6)
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+    return dataTable
+
+def createTest51():
+    output_file, exp_output_file = data_gen_utils.openFileHandles(51, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Load the indexed table tbl9\n')
+    output_file.write('--\n')
+    output_file.write('-- col1 has a clustered sorted index and col2 an unclustered sorted index\n')
+    output_file.write('create(tbl,"tbl9",db1,3)\n')
+    output_file.write('create(col,"col1",db1.tbl9)\n')
+    output_file.write('create(col,"col2",db1.tbl9)\n')
+    output_file.write('create(col,"col3",db1.tbl9)\n')
+    output_file.write('create(idx,db1.tbl9.col1,sorted,clustered)\n')
+    output_file.write('create(idx,db1.tbl9.col2,sorted,unclustered)\n')
+    output_file.write('load(\"'+DOCKER_TEST_BASE_DIR+'/data9.csv\")\n')
+    output_file.write('shutdown\n')
+    # no expected results
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createFusedAggregates(output_file, exp_output_file, dataTable, tableName, name):
+    selectValLess = np.random.randint(0, 500)
+    selectValGreater = selectValLess + np.random.randint(1, 500)
+    mask = (dataTable['col2'] >= selectValLess) & (dataTable['col2'] < selectValGreater)
+    selected = dataTable[mask]
+    output_file.write('-- SELECT sum(col3), avg(col3), min(col3), max(col3) FROM {} WHERE col2 >= {} AND col2 < {};\n'.format(tableName, selectValLess, selectValGreater))
+    for aggregate in ['sum', 'avg', 'min', 'max']:
+        output_file.write('{}{}={}(fetch(db1.{}.col3,select(db1.{}.col2,{},{})))\n'.format(aggregate, name, aggregate, tableName, tableName, selectValLess, selectValGreater))
+    output_file.write('print(sum{},avg{},min{},max{})\n'.format(name, name, name, name))
+    exp_output_file.write('{},{:0.2f},{},{}\n'.format(int(selected['col3'].sum()), selected['col3'].mean(), selected['col3'].min(), selected['col3'].max()))
+    output_file.write('-- SELECT min(col2), max(col2), count(*) FROM {} WHERE col2 >= {} AND col2 < {};\n'.format(tableName, selectValLess, selectValGreater))
+    output_file.write('lo{}=min(fetch(db1.{}.col2,select(db1.{}.col2,{},{})))\n'.format(name, tableName, tableName, selectValLess, selectValGreater))
+    output_file.write('hi{}=max(fetch(db1.{}.col2,select(db1.{}.col2,{},{})))\n'.format(name, tableName, tableName, selectValLess, selectValGreater))
+    output_file.write('count{}=count(select(db1.{}.col2,{},{}))\n'.format(name, tableName, selectValLess, selectValGreater))
+    output_file.write('print(lo{},hi{},count{})\n'.format(name, name, name))
+    exp_output_file.write('{},{},{}\n'.format(selected['col2'].min(), selected['col2'].max(), len(selected)))
+    output_file.write('-- SELECT count(*) FROM {} WHERE col1 >= {}; SELECT count(*) FROM {} WHERE col1 < 0;\n'.format(tableName, selectValLess, tableName))
+    output_file.write('all{}=count(select(db1.{}.col1,{},null))\n'.format(name, tableName, selectValLess))
+    output_file.write('none{}=count(select(db1.{}.col1,null,0))\n'.format(name, tableName))
+    output_file.write('print(all{},none{})\n'.format(name, name))
+    exp_output_file.write('{},{}\n'.format(int((dataTable['col1'] >= selectValLess).sum()), int((dataTable['col1'] < 0).sum())))
+
+def createTest52(filterTable, indexedTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(52, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: fused select-fetch aggregates and counts\n')
+    output_file.write('--\n')
+    output_file.write('-- Without indexes every aggregate is one pass over the selected rows\n')
+    createFusedAggregates(output_file, exp_output_file, filterTable, 'tbl8', '1')
+    output_file.write('--\n')
+    output_file.write('-- With sorted indexes counts and min/max of the select column are read off the index\n')
+    createFusedAggregates(output_file, exp_output_file, indexedTable, 'tbl9', '2')
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest53(dataTable, indexedTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(53, TEST_DIR=TEST_BASE_DIR)
+    selectValLess = np.random.randint(0, FILTER_TABLE_SIZE - 100)
+    selectValGreater = selectValLess + 20
+    largeConstant = 2**31 - 100
+    output_file.write('-- Correctness test: arithmetic with broadcast scalars\n')
+    output_file.write('--\n')
+    output_file.write('-- Integer operands are widened to LONG, integer division and anything with a\n')
+    output_file.write('-- fractional operand is DOUBLE and printed with two decimals\n')
+    output_file.write('-- SELECT col3*col4, col4*5000000, col3/7, -col4, col3*2.5, col3-avg(col3), col4+{} FROM tbl8 WHERE col1 >= {} AND col1 < {};\n'.format(largeConstant, selectValLess, selectValGreater))
+    output_file.write('s1=select(db1.tbl8.col1,{},{})\n'.format(selectValLess, selectValGreater))
+    output_file.write('f3=fetch(db1.tbl8.col3,s1)\n')
+    output_file.write('f4=fetch(db1.tbl8.col4,s1)\n')
+    output_file.write('m1=mul(f3,f4)\n')
+    output_file.write('m2=mul(f4,5000000)\n')
+    output_file.write('d1=div(f3,7)\n')
+    output_file.write('n1=neg(f4)\n')
+    output_file.write('b1=mul(f3,2.5)\n')
+    output_file.write('a3=avg(f3)\n')
+    output_file.write('b2=sub(f3,a3)\n')
+    output_file.write('b3=add(f4,{})\n'.format(largeConstant))
+    output_file.write('print(m1,m2,d1,n1,b1,b2,b3)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col3/col4, -(col3*2.5) FROM tbl8 WHERE col1 >= {} AND col1 < {} AND col4 >= 1;\n'.format(selectValLess, selectValGreater + 80))
+    output_file.write('s2=select(and(db1.tbl8.col1,{},{}),(db1.tbl8.col4,1,null))\n'.format(selectValLess, selectValGreater + 80))
+    output_file.write('g3=fetch(db1.tbl8.col3,s2)\n')
+    output_file.write('g4=fetch(db1.tbl8.col4,s2)\n')
+    output_file.write('d2=div(g3,g4)\n')
+    output_file.write('b4=mul(g3,2.5)\n')
+    output_file.write('n2=neg(b4)\n')
+    output_file.write('print(d2,n2)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT sum(col3*col4), max(col3/3) FROM tbl8;\n')
+    output_file.write('s3=select(db1.tbl8.col1,null,null)\n')
+    output_file.write('h3=fetch(db1.tbl8.col3,s3)\n')
+    output_file.write('h4=fetch(db1.tbl8.col4,s3)\n')
+    output_file.write('m3=mul(h3,h4)\n')
+    output_file.write('t1=sum(m3)\n')
+    output_file.write('d3=div(h3,3)\n')
+    output_file.write('t2=max(d3)\n')
+    output_file.write('print(t1,t2)\n')
+    output_file.write('--\n')
+    output_file.write('-- Selects on DOUBLE results, over position lists, bitmaps and ranges; the exclusive high\n')
+    output_file.write('-- bound h keeps values up to h-1, as for integers\n')
+    output_file.write('u1=select(s1,d1,20,100)\n')
+    output_file.write('p1=fetch(db1.tbl8.col1,u1)\n')
+    output_file.write('print(p1)\n')
+    output_file.write('u2=select(s3,d3,100,200)\n')
+    output_file.write('c2=count(u2)\n')
+    output_file.write('p2=fetch(db1.tbl8.col1,u2)\n')
+    output_file.write('t3=sum(p2)\n')
+    output_file.write('print(c2,t3)\n')
+    output_file.write('r1=select(db1.tbl9.col1,100,600)\n')
+    output_file.write('r3=fetch(db1.tbl9.col3,r1)\n')
+    output_file.write('r4=div(r3,4)\n')
+    output_file.write('u3=select(r1,r4,-100,50)\n')
+    output_file.write('c3=count(u3)\n')
+    output_file.write('v3=fetch(db1.tbl9.col3,u3)\n')
+    output_file.write('t4=sum(v3)\n')
+    output_file.write('print(c3,t4)\n')
+    output_file.write('--\n')
+    output_file.write('-- min/max of LONG and DOUBLE results that all lie outside the INT range\n')
+    output_file.write('-- SELECT min(col4*5000000), max(col4*5000000), max(-col4*5000000), min(-col4*5000000), max(col4*-5000000.5) FROM tbl8 WHERE col4 >= 450;\n')
+    output_file.write('s4=select(db1.tbl8.col4,450,null)\n')
+    output_file.write('k4=fetch(db1.tbl8.col4,s4)\n')
+    output_file.write('m4=mul(k4,5000000)\n')
+    output_file.write('n4=neg(m4)\n')
+    output_file.write('e4=mul(k4,-5000000.5)\n')
+    output_file.write('x1=min(m4)\n')
+    output_file.write('x2=max(m4)\n')
+    output_file.write('x3=max(n4)\n')
+    output_file.write('x4=min(n4)\n')
+    output_file.write('x5=max(e4)\n')
+    output_file.write('print(x1,x2,x3,x4,x5)\n')
+    # generate expected results
+    dfSelectMask = (dataTable['col1'] >= selectValLess) & (dataTable['col1'] < selectValGreater)
+    selected = dataTable[dfSelectMask]
+    col3 = selected['col3'].astype(np.int64)
+    col4 = selected['col4'].astype(np.int64)
+    average = col3.mean()
+    for x, y in zip(col3, col4):
+        exp_output_file.write('{},{},{:0.2f},{},{:0.2f},{:0.2f},{}\n'.format(x * y, y * 5000000, x / 7, -y, x * 2.5, x - average, y + largeConstant))
+    dfSelectMask = (dataTable['col1'] >= selectValLess) & (dataTable['col1'] < selectValGreater + 80) & (dataTable['col4'] >= 1)
+    selected = dataTable[dfSelectMask]
+    for x, y in zip(selected['col3'], selected['col4']):
+        exp_output_file.write('{:0.2f},{:0.2f}\n'.format(x / y, -(x * 2.5)))
+    col3 = dataTable['col3'].astype(np.int64)
+    col4 = dataTable['col4'].astype(np.int64)
+    exp_output_file.write('{},{:0.2f}\n'.format(int((col3 * col4).sum()), (col3 / 3).max()))
+    dfSelectMask = (dataTable['col1'] >= selectValLess) & (dataTable['col1'] < selectValGreater)
+    quotient = dataTable['col3'] / 7
+    output = dataTable[dfSelectMask & (quotient >= 20) & (quotient <= 99)]['col1']
+    if len(output) > 0:
+        exp_output_file.write(data_gen_utils.outputPrint(output))
+        exp_output_file.write('\n')
+    quotient = dataTable['col3'] / 3
+    dfSelectMask = (quotient >= 100) & (quotient <= 199)
+    exp_output_file.write('{},{}\n'.format(int(dfSelectMask.sum()), int(dataTable[dfSelectMask]['col1'].sum())))
+    quotient = indexedTable['col3'] / 4
+    dfSelectMask = (indexedTable['col1'] >= 100) & (indexedTable['col1'] < 600) & (quotient >= -100) & (quotient <= 49)
+    exp_output_file.write('{},{}\n'.format(int(dfSelectMask.sum()), int(indexedTable[dfSelectMask]['col3'].sum())))
+    col4 = dataTable[dataTable['col4'] >= 450]['col4'].astype(np.int64)
+    exp_output_file.write('{},{},{},{},{:0.2f}\n'.format((col4 * 5000000).min(), (col4 * 5000000).max(), -(col4 * 5000000).min(), -(col4 * 5000000).max(), (col4 * -5000000.5).max()))
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def writeColumns(exp_output_file, dataTable, mask, columns):
+    output = dataTable[mask][columns]
+    if len(output) > 0:
+        exp_output_file.write(output.to_csv(header=False, index=False))
+
+def createTest54(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(54, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: fetch of several columns in one pass\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col3, col4 FROM tbl8 WHERE col2 >= 100 AND col2 < 105;\n')
+    output_file.write('s1=select(db1.tbl8.col2,100,105)\n')
+    output_file.write('f1,f2=fetch(db1.tbl8.(col3,col4),s1)\n')
+    output_file.write('print(f1,f2)\n')
+    output_file.write('--\n')
+    output_file.write('-- SELECT col1, col2, col4 FROM tbl8 WHERE col3 >= 0 AND col3 < 500 AND col1 < 2000;\n')
+    output_file.write('s2=select(db1.tbl8.col3,0,500)\n')
+    output_file.write('f3=fetch(db1.tbl8.col1,s2)\n')
+    output_file.write('s3=select(s2,f3,null,2000)\n')
+    output_file.write('f4,f5,f6=fetch(db1.tbl8.(col1,col2,col4),s3)\n')
+    output_file.write('print(f4,f5,f6)\n')
+    output_file.write('--\n')
+    output_file.write('-- Consecutive batched fetches of the same positions run as one fetch\n')
+    output_file.write('-- SELECT col1, col3, col4 FROM tbl8 WHERE col2 >= 200 AND col2 < 205;\n')
+    output_file.write('-- SELECT col1, col3, col4, col2 FROM tbl8 WHERE col2 >= 700 AND col2 < 703;\n')
+    output_file.write('batch_queries()\n')
+    output_file.write('s11=select(db1.tbl8.col2,200,205)\n')
+    output_file.write('s12=select(db1.tbl8.col2,700,703)\n')
+    output_file.write('f11=fetch(db1.tbl8.col1,s11)\n')
+    output_file.write('f12=fetch(db1.tbl8.col3,s11)\n')
+    output_file.write('f13=fetch(db1.tbl8.col4,s11)\n')
+    output_file.write('f21=fetch(db1.tbl8.col1,s12)\n')
+    output_file.write('f22,f23=fetch(db1.tbl8.(col3,col4),s12)\n')
+    output_file.write('f14=fetch(db1.tbl8.col2,s11)\n')
+    output_file.write('f24=fetch(db1.tbl8.col2,s12)\n')
+    output_file.write('batch_execute()\n')
+    output_file.write('print(f11,f12,f13)\n')
+    output_file.write('print(f21,f22,f23,f24)\n')
+    output_file.write('print(f14)\n')
+    # generate expected results
+    mask = (dataTable['col2'] >= 100) & (dataTable['col2'] < 105)
+    writeColumns(exp_output_file, dataTable, mask, ['col3', 'col4'])
+    mask = (dataTable['col3'] >= 0) & (dataTable['col3'] < 500) & (dataTable['col1'] < 2000)
+    writeColumns(exp_output_file, dataTable, mask, ['col1', 'col2', 'col4'])
+    mask1 = (dataTable['col2'] >= 200) & (dataTable['col2'] < 205)
+    mask2 = (dataTable['col2'] >= 700) & (dataTable['col2'] < 703)
+    writeColumns(exp_output_file, dataTable, mask1, ['col1', 'col3', 'col4'])
+    writeColumns(exp_output_file, dataTable, mask2, ['col1', 'col3', 'col4', 'col2'])
+    writeColumns(exp_output_file, dataTable, mask1, ['col2'])
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest55():
+    output_file, exp_output_file = data_gen_utils.openFileHandles(55, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Load the wide table tbl10\n')
+    output_file.write('--\n')
+    output_file.write('-- col1 is uniform and unindexed, col2 and col3 lie above INT_MAX / 2 and col4 below INT_MIN / 2\n')
+    output_file.write('create(tbl,"tbl10",db1,4)\n')
+    output_file.write('create(col,"col1",db1.tbl10)\n')
+    output_file.write('create(col,"col2",db1.tbl10)\n')
+    output_file.write('create(col,"col3",db1.tbl10)\n')
+    output_file.write('create(col,"col4",db1.tbl10)\n')
+    output_file.write('load(\"'+DOCKER_TEST_BASE_DIR+'/data10.csv\")\n')
+    output_file.write('shutdown\n')
+    # no expected results
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest56(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(56, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: deferred select, fetch, add/sub and aggregates run as one pipeline\n')
+    output_file.write('--\n')
+    output_file.write('-- Nothing is printed until the end, so the whole chain is evaluated in one pass over col1\n')
+    selectValLess = np.random.randint(0, 500)
+    selectValGreater = selectValLess + np.random.randint(100, 500)
+    output_file.write('-- SELECT min(col2+col3), max(col2+col3), avg(col2+col3), min(col4-col2), max(col4-col2), sum(col4-col2), min(col2), max(col4) FROM tbl10 WHERE col1 >= {} AND col1 < {};\n'.format(selectValLess, selectValGreater))
+    output_file.write('s1=select(db1.tbl10.col1,{},{})\n'.format(selectValLess, selectValGreater))
+    output_file.write('f2=fetch(db1.tbl10.col2,s1)\n')
+    output_file.write('f3=fetch(db1.tbl10.col3,s1)\n')
+    output_file.write('f4=fetch(db1.tbl10.col4,s1)\n')
+    output_file.write('add23=add(f2,f3)\n')
+    output_file.write('sub42=sub(f4,f2)\n')
+    output_file.write('out1=min(add23)\n')
+    output_file.write('out2=max(add23)\n')
+    output_file.write('out3=avg(add23)\n')
+    output_file.write('out4=min(sub42)\n')
+    output_file.write('out5=max(sub42)\n')
+    output_file.write('out6=sum(sub42)\n')
+    output_file.write('out7=min(f2)\n')
+    output_file.write('out8=max(f4)\n')
+    output_file.write('print(out1,out2,out3,out4,out5,out6,out7,out8)\n')
+    # generate expected results
+    selected = dataTable[(dataTable['col1'] >= selectValLess) & (dataTable['col1'] < selectValGreater)]
+    add23 = selected['col2'] + selected['col3']
+    sub42 = selected['col4'] - selected['col2']
+    exp_output_file.write('{},{},{:0.2f},{},{},{},{},{}\n'.format(add23.min(), add23.max(), add23.mean(), sub42.min(), sub42.max(), int(sub42.sum()), selected['col2'].min(), selected['col4'].max()))
+    output_file.write('--\n')
+    output_file.write('-- A select over values fetched at deferred positions filters inside the pipeline\n')
+    wideLess = WIDE_VALUE_LOW + 200000000
+    wideGreater = WIDE_VALUE_HIGH - 300000000
+    output_file.write('-- SELECT sum(col2+col3), max(col3), min(col2), avg(col2) FROM tbl10 WHERE col1 >= {} AND col1 < {} AND col2 >= {} AND col2 < {};\n'.format(selectValLess, selectValGreater, wideLess, wideGreater))
+    output_file.write('s2=select(db1.tbl10.col1,{},{})\n'.format(selectValLess, selectValGreater))
+    output_file.write('g2=fetch(db1.tbl10.col2,s2)\n')
+    output_file.write('s3=select(s2,g2,{},{})\n'.format(wideLess, wideGreater))
+    output_file.write('h2=fetch(db1.tbl10.col2,s3)\n')
+    output_file.write('h3=fetch(db1.tbl10.col3,s3)\n')
+    output_file.write('add23f=add(h2,h3)\n')
+    output_file.write('out9=sum(add23f)\n')
+    output_file.write('out10=max(h3)\n')
+    output_file.write('out11=min(h2)\n')
+    output_file.write('out12=avg(h2)\n')
+    output_file.write('print(out9,out10,out11,out12)\n')
+    selected = dataTable[(dataTable['col1'] >= selectValLess) & (dataTable['col1'] < selectValGreater) & (dataTable['col2'] >= wideLess) & (dataTable['col2'] < wideGreater)]
+    exp_output_file.write('{},{},{},{:0.2f}\n'.format(int((selected['col2'] + selected['col3']).sum()), selected['col3'].max(), selected['col2'].min(), selected['col2'].mean()))
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest57():
+    output_file, exp_output_file = data_gen_utils.openFileHandles(57, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Load the join table tbl11\n')
+    output_file.write('--\n')
+    output_file.write('-- col1 and col2 are keys with about {} duplicates each, joined with each other\n'.format(JOIN_TABLE_SIZE // JOIN_KEYS))
+    output_file.write('create(tbl,"tbl11",db1,2)\n')
+    output_file.write('create(col,"col1",db1.tbl11)\n')
+    output_file.write('create(col,"col2",db1.tbl11)\n')
+    output_file.write('load(\"'+DOCKER_TEST_BASE_DIR+'/data11.csv\")\n')
+    output_file.write('shutdown\n')
+    # no expected results
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createJoin(output_file, exp_output_file, dataTable, joinType, name, leftMask, rightMask):
+    # the pairs come out in any order, so they are checked through order independent aggregates
+    output_file.write('t{}l,t{}r=join(f{}l,p{}l,f{}r,p{}r,{})\n'.format(name, name, name, name, name, name, joinType))
+    output_file.write('v{}l=fetch(db1.tbl11.col2,t{}l)\n'.format(name, name))
+    output_file.write('v{}r=fetch(db1.tbl11.col1,t{}r)\n'.format(name, name))
+    output_file.write('c{}=count(t{}l)\n'.format(name, name))
+    output_file.write('sl{}=sum(t{}l)\n'.format(name, name))
+    output_file.write('sr{}=sum(t{}r)\n'.format(name, name))
+    output_file.write('al{}=sum(v{}l)\n'.format(name, name))
+    output_file.write('ar{}=sum(v{}r)\n'.format(name, name))
+    output_file.write('print(c{},sl{},sr{},al{},ar{})\n'.format(name, name, name, name, name))
+    left = pd.DataFrame({'key': dataTable['col1'], 'lpos': dataTable.index, 'lval': dataTable['col2']})[leftMask]
+    right = pd.DataFrame({'key': dataTable['col2'], 'rpos': dataTable.index, 'rval': dataTable['col1']})[rightMask]
+    joined = left.merge(right, on='key')
+    exp_output_file.write('{},{},{},{},{}\n'.format(len(joined), int(joined['lpos'].sum()), int(joined['rpos'].sum()), int(joined['lval'].sum()), int(joined['rval'].sum())))
+
+def createJoinInputs(output_file, name, leftLess, leftGreater, rightLess, rightGreater):
+    output_file.write('p{}l=select(db1.tbl11.col1,{},{})\n'.format(name, leftLess, leftGreater))
+    output_file.write('f{}l=fetch(db1.tbl11.col1,p{}l)\n'.format(name, name))
+    output_file.write('p{}r=select(db1.tbl11.col2,{},{})\n'.format(name, rightLess, rightGreater))
+    output_file.write('f{}r=fetch(db1.tbl11.col2,p{}r)\n'.format(name, name))
+
+def createTest58(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(58, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: hash and nested-loop joins with duplicate keys\n')
+    output_file.write('--\n')
+    output_file.write('-- Each join prints count(*), the sums of the joined positions of both sides and sums of a value fetched through each\n')
+    output_file.write('-- SELECT count(*), sum(a.pos), sum(b.pos), sum(a.col2), sum(b.col1) FROM tbl11 a, tbl11 b WHERE a.col1 = b.col2;\n')
+    output_file.write('-- Both sides are large enough for a radix join in two partitioning passes\n')
+    createJoinInputs(output_file, '1', 'null', 'null', 'null', 'null')
+    everything = dataTable['col1'] >= 0
+    createJoin(output_file, exp_output_file, dataTable, 'hash', '1', everything, everything)
+    leftLess = np.random.randint(0, JOIN_KEYS // 2)
+    leftGreater = leftLess + 2000
+    rightLess = leftLess + np.random.randint(500, 1500)
+    rightGreater = rightLess + 2000
+    leftMask = (dataTable['col1'] >= leftLess) & (dataTable['col1'] < leftGreater)
+    rightMask = (dataTable['col2'] >= rightLess) & (dataTable['col2'] < rightGreater)
+    output_file.write('--\n')
+    output_file.write('-- SELECT count(*), sum(a.pos), sum(b.pos), sum(a.col2), sum(b.col1) FROM tbl11 a, tbl11 b WHERE a.col1 = b.col2 AND a.col1 >= {} AND a.col1 < {} AND b.col2 >= {} AND b.col2 < {};\n'.format(leftLess, leftGreater, rightLess, rightGreater))
+    output_file.write('-- The same join nested-loop and through the radix join, whose build side fits one partition\n')
+    createJoinInputs(output_file, '2', leftLess, leftGreater, rightLess, rightGreater)
+    createJoin(output_file, exp_output_file, dataTable, 'nested-loop', '2', leftMask, rightMask)
+    createJoin(output_file, exp_output_file, dataTable, 'hash', '2', leftMask, rightMask)
+    # about JOIN_KEYS / JOIN_TABLE_SIZE * JOIN_CACHE_ROWS keys keep the right side small enough to hash whole
+    rightGreater = rightLess + JOIN_CACHE_ROWS * JOIN_KEYS // JOIN_TABLE_SIZE // 2
+    rightMask = (dataTable['col2'] >= rightLess) & (dataTable['col2'] < rightGreater)
+    output_file.write('--\n')
+    output_file.write('-- SELECT count(*), sum(a.pos), sum(b.pos), sum(a.col2), sum(b.col1) FROM tbl11 a, tbl11 b WHERE a.col1 = b.col2 AND a.col1 >= {} AND a.col1 < {} AND b.col2 >= {} AND b.col2 < {};\n'.format(leftLess, leftGreater, rightLess, rightGreater))
+    output_file.write('-- The right side fits one hash table, nested-loop and hash again\n')
+    createJoinInputs(output_file, '3', leftLess, leftGreater, rightLess, rightGreater)
+    createJoin(output_file, exp_output_file, dataTable, 'nested-loop', '3', leftMask, rightMask)
+    createJoin(output_file, exp_output_file, dataTable, 'hash', '3', leftMask, rightMask)
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest59(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(59, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: selects over bitmap positions\n')
+    output_file.write('--\n')
+    output_file.write('-- s1 keeps most rows, so counting it runs the scan into a bitmap; the positions are then\n')
+    output_file.write('-- aggregated, fetched through and filtered again while they are a bitmap\n')
+    output_file.write('-- SELECT count(*), sum(col1), min(col1), max(col1) FROM tbl8 WHERE col3 >= 0 AND col3 < 900;\n')
+    output_file.write('s1=select(db1.tbl8.col3,0,900)\n')
+    output_file.write('c1=count(s1)\n')
+    output_file.write('sp1=sum(s1)\n')
+    output_file.write('lo1=min(s1)\n')
+    output_file.write('hi1=max(s1)\n')
+    output_file.write('print(c1,sp1,lo1,hi1)\n')
+    mask = (dataTable['col3'] >= 0) & (dataTable['col3'] < 900)
+    selected = dataTable[mask]
+    exp_output_file.write('{},{},{},{}\n'.format(len(selected), int(selected['col1'].sum()), selected['col1'].min(), selected['col1'].max()))
+    output_file.write('-- SELECT count(*), sum(col1), sum(col3) FROM tbl8 WHERE col3 >= 0 AND col3 < 900 AND col4 >= -100 AND col4 < 100;\n')
+    output_file.write('f4=fetch(db1.tbl8.col4,s1)\n')
+    output_file.write('s2=select(s1,f4,-100,100)\n')
+    output_file.write('c2=count(s2)\n')
+    output_file.write('p2=fetch(db1.tbl8.col1,s2)\n')
+    output_file.write('v2=fetch(db1.tbl8.col3,s2)\n')
+    output_file.write('sp2=sum(p2)\n')
+    output_file.write('sv2=sum(v2)\n')
+    output_file.write('print(c2,sp2,sv2)\n')
+    selected = dataTable[mask & (dataTable['col4'] >= -100) & (dataTable['col4'] < 100)]
+    exp_output_file.write('{},{},{}\n'.format(len(selected), int(selected['col1'].sum()), int(selected['col3'].sum())))
+    output_file.write('-- SELECT col1, col3, col4 FROM tbl8 WHERE col3 >= 0 AND col3 < 900 AND col4 >= 498;\n')
+    output_file.write('s3=select(s1,f4,498,null)\n')
+    output_file.write('p3,v3,w3=fetch(db1.tbl8.(col1,col3,col4),s3)\n')
+    output_file.write('print(p3,v3,w3)\n')
+    writeColumns(exp_output_file, dataTable, mask & (dataTable['col4'] >= 498), ['col1', 'col3', 'col4'])
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest60():
+    output_file, exp_output_file = data_gen_utils.openFileHandles(60, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Load the range table tbl12\n')
+    output_file.write('--\n')
+    output_file.write('-- col1 is the row position, col2 has an unclustered sorted index and holds runs of {} equal keys\n'.format(RANGE_RUN_ROWS))
+    output_file.write('create(tbl,"tbl12",db1,3)\n')
+    output_file.write('create(col,"col1",db1.tbl12)\n')
+    output_file.write('create(col,"col2",db1.tbl12)\n')
+    output_file.write('create(col,"col3",db1.tbl12)\n')
+    output_file.write('create(idx,db1.tbl12.col2,sorted,unclustered)\n')
+    output_file.write('load(\"'+DOCKER_TEST_BASE_DIR+'/data12.csv\")\n')
+    output_file.write('shutdown\n')
+    # no expected results
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest61(rangeTable, indexedTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(61, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: selects over range encoded positions\n')
+    output_file.write('--\n')
+    output_file.write('-- An index select of a few runs of tbl12.col2 is a handful of position ranges, which are\n')
+    output_file.write('-- aggregated, fetched through and filtered again while they are ranges\n')
+    keyLess = np.random.randint(1, RANGE_TABLE_SIZE // RANGE_RUN_ROWS - 2 * RANGE_RUN_GROUP)
+    keyGreater = keyLess + RANGE_RUN_GROUP + RANGE_RUN_GROUP // 2
+    output_file.write('-- SELECT count(*), sum(col1), min(col1), max(col1) FROM tbl12 WHERE col2 >= {} AND col2 < {};\n'.format(keyLess, keyGreater))
+    output_file.write('r1=select(db1.tbl12.col2,{},{})\n'.format(keyLess, keyGreater))
+    output_file.write('c1=count(r1)\n')
+    output_file.write('sp1=sum(r1)\n')
+    output_file.write('lo1=min(r1)\n')
+    output_file.write('hi1=max(r1)\n')
+    output_file.write('print(c1,sp1,lo1,hi1)\n')
+    mask = (rangeTable['col2'] >= keyLess) & (rangeTable['col2'] < keyGreater)
+    selected = rangeTable[mask]
+    exp_output_file.write('{},{},{},{}\n'.format(len(selected), int(selected['col1'].sum()), selected['col1'].min(), selected['col1'].max()))
+    output_file.write('-- SELECT col1, col2, col3 FROM tbl12 WHERE col2 >= {} AND col2 < {} AND col3 >= 900;\n'.format(keyLess, keyGreater))
+    output_file.write('f3=fetch(db1.tbl12.col3,r1)\n')
+    output_file.write('t1=select(r1,f3,900,null)\n')
+    output_file.write('p1,k1,v1=fetch(db1.tbl12.(col1,col2,col3),t1)\n')
+    output_file.write('print(p1,k1,v1)\n')
+    writeColumns(exp_output_file, rangeTable, mask & (rangeTable['col3'] >= 900), ['col1', 'col2', 'col3'])
+    output_file.write('--\n')
+    output_file.write('-- A clustered index select is one range\n')
+    selectValLess = np.random.randint(0, 500)
+    selectValGreater = selectValLess + np.random.randint(1, 500)
+    output_file.write('-- SELECT count(*), sum(pos), min(pos), max(pos) FROM tbl9 WHERE col1 >= {} AND col1 < {};\n'.format(selectValLess, selectValGreater))
+    output_file.write('r2=select(db1.tbl9.col1,{},{})\n'.format(selectValLess, selectValGreater))
+    output_file.write('c2=count(r2)\n')
+    output_file.write('sp2=sum(r2)\n')
+    output_file.write('lo2=min(r2)\n')
+    output_file.write('hi2=max(r2)\n')
+    output_file.write('print(c2,sp2,lo2,hi2)\n')
+    # the rows of tbl9 are stored in col1 order, so the selected positions are those after the smaller keys
+    start = int((indexedTable['col1'] < selectValLess).sum())
+    end = int((indexedTable['col1'] < selectValGreater).sum())
+    exp_output_file.write('{},{},{},{}\n'.format(end - start, sum(range(start, end)), start, end - 1))
+    output_file.write('-- SELECT count(*), sum(col1), sum(col3) FROM tbl9 WHERE col1 >= {} AND col1 < {} AND col3 >= -500 AND col3 < 500;\n'.format(selectValLess, selectValGreater))
+    output_file.write('g3=fetch(db1.tbl9.col3,r2)\n')
+    output_file.write('t2=select(r2,g3,-500,500)\n')
+    output_file.write('c3=count(t2)\n')
+    output_file.write('k3,v3=fetch(db1.tbl9.(col1,col3),t2)\n')
+    output_file.write('sk3=sum(k3)\n')
+    output_file.write('sv3=sum(v3)\n')
+    output_file.write('print(c3,sk3,sv3)\n')
+    selected = indexedTable[(indexedTable['col1'] >= selectValLess) & (indexedTable['col1'] < selectValGreater) & (indexedTable['col3'] >= -500) & (indexedTable['col3'] < 500)]
+    exp_output_file.write('{},{},{}\n'.format(len(selected), int(selected['col1'].sum()), int(selected['col3'].sum())))
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createTest62(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(62, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: fetches of consecutive positions borrow the column\n')
+    output_file.write('--\n')
+    output_file.write('-- col1 of tbl8 is the row position, so a select on it picks consecutive rows; counting the select\n')
+    output_file.write('-- runs its scan, and the fetches through it are views of the columns\n')
+    selectValLess = np.random.randint(0, FILTER_TABLE_SIZE - 30000)
+    selectValGreater = selectValLess + 200
+    output_file.write('-- SELECT col1, col3, col4 FROM tbl8 WHERE col1 >= {} AND col1 < {};\n'.format(selectValLess, selectValGreater))
+    output_file.write('s1=select(db1.tbl8.col1,{},{})\n'.format(selectValLess, selectValGreater))
+    output_file.write('c1=count(s1)\n')
+    output_file.write('f1,f3,f4=fetch(db1.tbl8.(col1,col3,col4),s1)\n')
+    output_file.write('print(f1,f3,f4)\n')
+    mask = (dataTable['col1'] >= selectValLess) & (dataTable['col1'] < selectValGreater)
+    selected = dataTable[mask]
+    writeColumns(exp_output_file, dataTable, mask, ['col1', 'col3', 'col4'])
+    output_file.write('-- SELECT count(*), sum(col3), avg(col3), min(col4), max(col4), sum(col3*col4) FROM tbl8 WHERE col1 >= {} AND col1 < {};\n'.format(selectValLess, selectValGreater))
+    output_file.write('sv3=sum(f3)\n')
+    output_file.write('av3=avg(f3)\n')
+    output_file.write('lo4=min(f4)\n')
+    output_file.write('hi4=max(f4)\n')
+    output_file.write('m34=mul(f3,f4)\n')
+    output_file.write('sm34=sum(m34)\n')
+    output_file.write('print(c1,sv3,av3,lo4,hi4,sm34)\n')
+    exp_output_file.write('{},{},{:0.2f},{},{},{}\n'.format(len(selected), int(selected['col3'].sum()), selected['col3'].mean(), selected['col4'].min(), selected['col4'].max(), int((selected['col3'] * selected['col4']).sum())))
+    output_file.write('-- SELECT col1 FROM tbl8 WHERE col1 >= {} AND col1 < {} AND col3 >= 0 AND col3 < 100;\n'.format(selectValLess, selectValGreater))
+    output_file.write('t1=select(s1,f3,0,100)\n')
+    output_file.write('p1=fetch(db1.tbl8.col1,t1)\n')
+    output_file.write('print(p1)\n')
+    writeColumns(exp_output_file, dataTable, mask & (dataTable['col3'] >= 0) & (dataTable['col3'] < 100), ['col1'])
+    output_file.write('--\n')
+    output_file.write('-- s2 keeps enough rows to be a bitmap, of consecutive rows\n')
+    selectValGreater = selectValLess + 20000
+    output_file.write('-- SELECT count(*), sum(col4), min(col4), max(col4) FROM tbl8 WHERE col1 >= {} AND col1 < {};\n'.format(selectValLess, selectValGreater))
+    output_file.write('s2=select(db1.tbl8.col1,{},{})\n'.format(selectValLess, selectValGreater))
+    output_file.write('c2=count(s2)\n')
+    output_file.write('g4=fetch(db1.tbl8.col4,s2)\n')
+    output_file.write('sg4=sum(g4)\n')
+    output_file.write('lg4=min(g4)\n')
+    output_file.write('hg4=max(g4)\n')
+    output_file.write('print(c2,sg4,lg4,hg4)\n')
+    mask = (dataTable['col1'] >= selectValLess) & (dataTable['col1'] < selectValGreater)
+    selected = dataTable[mask]
+    exp_output_file.write('{},{},{},{}\n'.format(len(selected), int(selected['col4'].sum()), selected['col4'].min(), selected['col4'].max()))
+    output_file.write('-- SELECT col1, col4 FROM tbl8 WHERE col1 >= {} AND col1 < {} AND col4 >= 495;\n'.format(selectValLess, selectValGreater))
+    output_file.write('t2=select(s2,g4,495,null)\n')
+    output_file.write('p2,q2=fetch(db1.tbl8.(col1,col4),t2)\n')
+    output_file.write('print(p2,q2)\n')
+    writeColumns(exp_output_file, dataTable, mask & (dataTable['col4'] >= 495), ['col1', 'col4'])
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def createColumnAggregates(output_file, exp_output_file, dataTable, name):
+    output_file.write('-- SELECT sum(col1), avg(col1), min(col1), max(col1), sum(col2), avg(col2), min(col2), max(col4) FROM tbl10;\n')
+    output_file.write('s{}a=sum(db1.tbl10.col1)\n'.format(name))
+    output_file.write('a{}a=avg(db1.tbl10.col1)\n'.format(name))
+    output_file.write('l{}a=min(db1.tbl10.col1)\n'.format(name))
+    output_file.write('h{}a=max(db1.tbl10.col1)\n'.format(name))
+    output_file.write('s{}b=sum(db1.tbl10.col2)\n'.format(name))
+    output_file.write('a{}b=avg(db1.tbl10.col2)\n'.format(name))
+    output_file.write('l{}b=min(db1.tbl10.col2)\n'.format(name))
+    output_file.write('h{}d=max(db1.tbl10.col4)\n'.format(name))
+    output_file.write('print(s{}a,a{}a,l{}a,h{}a,s{}b,a{}b,l{}b,h{}d)\n'.format(name, name, name, name, name, name, name, name))
+    exp_output_file.write('{},{:0.2f},{},{},{},{:0.2f},{},{}\n'.format(int(dataTable['col1'].sum()), dataTable['col1'].mean(), dataTable['col1'].min(), dataTable['col1'].max(),
+                                                                      int(dataTable['col2'].sum()), dataTable['col2'].mean(), dataTable['col2'].min(), dataTable['col4'].max()))
+
+def createTest63(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(63, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: aggregates of whole columns read the column statistics\n')
+    output_file.write('--\n')
+    output_file.write('-- The statistics are kept up to date by inserts\n')
+    createColumnAggregates(output_file, exp_output_file, dataTable, '1')
+    insertedRows = [[-7, 2147483000, 1500000000, -1000000000], [5000, 1000000000, 1200000000, -2147483000]]
+    for row in insertedRows:
+        output_file.write('-- INSERT INTO tbl10 VALUES ({},{},{},{});\n'.format(row[0], row[1], row[2], row[3]))
+        output_file.write('relational_insert(db1.tbl10,{},{},{},{})\n'.format(row[0], row[1], row[2], row[3]))
+    dataTable = pd.concat([dataTable, pd.DataFrame(insertedRows, columns=['col1', 'col2', 'col3', 'col4'])], ignore_index = True)
+    createColumnAggregates(output_file, exp_output_file, dataTable, '2')
+    # the inserts are kept for the following tests
+    output_file.write('shutdown\n')
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+    return dataTable
+
+def createTest64(dataTable):
+    output_file, exp_output_file = data_gen_utils.openFileHandles(64, TEST_DIR=TEST_BASE_DIR)
+    output_file.write('-- Correctness test: column statistics after a restart\n')
+    output_file.write('--\n')
+    output_file.write('-- The rows inserted by the previous test are part of the statistics of the reloaded columns\n')
+    createColumnAggregates(output_file, exp_output_file, dataTable, '1')
+    data_gen_utils.closeFileHandles(output_file, exp_output_file)
+
+def generateMilestoneSixFiles(dataSize, randomSeed=47):
+    np.random.seed(randomSeed)
+    dataTable = generateDataGroupBy(dataSize)
+    createTest44()
+    createTest45(dataTable, 0.5)
+    sortedTable = generateDataSortedGroupBy()
+    createTest46()
+    createTest47(sortedTable)
+    filterTable = generateDataFilter()
+    createTest48()
+    createTest49(filterTable)
+    filterTable = createTest50(filterTable)
+    indexedTable = generateDataSortedIndex(dataSize)
+    createTest51()
+    createTest52(filterTable, indexedTable)
+    createTest53(filterTable, indexedTable)
+    createTest54(filterTable)
+    wideTable = generateDataWide()
+    createTest55()
+    createTest56(wideTable)
+    joinTable = generateDataJoin()
+    createTest57()
+    createTest58(joinTable)
+    createTest59(filterTable)
+    rangeTable = generateDataRanges()
+    createTest60()
+    createTest61(rangeTable, indexedTable)
+    createTest62(filterTable)
+    wideTable = createTest63(wideTable)
+    createTest64(wideTable)
+
+def main(argv):
+    global TEST_BASE_DIR
+    global DOCKER_TEST_BASE_DIR
+    dataSize = int(argv[0])
+    if len(argv) > 1:
+        randomSeed = int(argv[1])
+    else:
+        randomSeed = 47
+
+    if len(argv) > 2:
+        TEST_BASE_DIR = argv[2]
+        if len(argv) > 3:
+            DOCKER_TEST_BASE_DIR = argv[3]
+
+    generateMilestoneSixFiles(dataSize, randomSeed=randomSeed)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,160 @@
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "arith.h"
+
+typedef void (*ArithKernel)(const void *left, const void *right, void *out, size_t start, size_t end);
+
+// vector-vector, vector-scalar and scalar-vector forms of one operator over one operand pair
+typedef struct ArithKernels
+{
+    ArithKernel vv;
+    ArithKernel vs;
+    ArithKernel sv;
+} ArithKernels;
+
+/*
+ * The three forms of out = left OP right computed in OUT. Operands are
+ * converted before the operator, so int + int cannot overflow into a LONG
+ * result. The loops are kept simple enough for the compiler to vectorize.
+ */
+#define ARITH_KERNEL(ATTR, NAME, OP, OUT, LEFT, RIGHT)                                                   \
+    ATTR static void NAME##_vv(const void *left, const void *right, void *out, size_t start, size_t end) \
+    {                                                                                                    \
+        const LEFT *restrict x = left;                                                                   \
+        const RIGHT *restrict y = right;                                                                 \
+        OUT *restrict z = out;                                                                           \
+        for (size_t i = start; i < end; i++)                                                             \
+            z[i] = (OUT)x[i] OP (OUT)y[i];                                                               \
+    }                                                                                                    \
+                                                                                                         \
+    ATTR static void NAME##_vs(const void *left, const void *right, void *out, size_t start, size_t end) \
+    {                                                                                                    \
+        const LEFT *restrict x = left;                                                                   \
+        OUT y = (OUT)*(const RIGHT *)right;                                                              \
+        OUT *restrict z = out;                                                                           \
+        for (size_t i = start; i < end; i++)                                                             \
+            z[i] = (OUT)x[i] OP y;                                                                       \
+    }                                                                                                    \
+                                                                                                         \
+    ATTR static void NAME##_sv(const void *left, const void *right, void *out, size_t start, size_t end) \
+    {                                                                                                    \
+        OUT x = (OUT)*(const LEFT *)left;                                                                \
+        const RIGHT *restrict y = right;                                                                 \
+        OUT *restrict z = out;                                                                           \
+        for (size_t i = start; i < end; i++)                                                             \
+            z[i] = x OP (OUT)y[i];                                                                       \
+    }
+
+#define ARITH_ENTRY(ATTR, NAME, OP, OUT, LEFT, RIGHT) {NAME##_vv, NAME##_vs, NAME##_sv},
+
+// every operand pair in DataType order with the type it is computed in; INTEGER is used for two integers
+#define ARITH_PAIRS(X, ATTR, NAME, OP, INTEGER)             \
+    X(ATTR, NAME##_int_int, OP, INTEGER, int, int)          \
+    X(ATTR, NAME##_int_long, OP, INTEGER, int, long)        \
+    X(ATTR, NAME##_int_float, OP, float, int, float)        \
+    X(ATTR, NAME##_int_double, OP, double, int, double)     \
+    X(ATTR, NAME##_long_int, OP, INTEGER, long, int)        \
+    X(ATTR, NAME##_long_long, OP, INTEGER, long, long)      \
+    X(ATTR, NAME##_long_float, OP, float, long, float)      \
+    X(ATTR, NAME##_long_double, OP, double, long, double)   \
+    X(ATTR, NAME##_float_int, OP, float, float, int)        \
+    X(ATTR, NAME##_float_long, OP, float, float, long)      \
+    X(ATTR, NAME##_float_float, OP, float, float, float)    \
+    X(ATTR, NAME##_float_double, OP, double, float, double) \
+    X(ATTR, NAME##_double_int, OP, double, double, int)     \
+    X(ATTR, NAME##_double_long, OP, double, double, long)   \
+    X(ATTR, NAME##_double_float, OP, double, double, float) \
+    X(ATTR, NAME##_double_double, OP, double, double, double)
+
+#define AVX2 __attribute__((target("avx2")))
+
+ARITH_PAIRS(ARITH_KERNEL, , scalar_add, +, long)
+ARITH_PAIRS(ARITH_KERNEL, , scalar_sub, -, long)
+ARITH_PAIRS(ARITH_KERNEL, , scalar_mul, *, long)
+ARITH_PAIRS(ARITH_KERNEL, , scalar_div, /, double)
+
+ARITH_PAIRS(ARITH_KERNEL, AVX2, avx2_add, +, long)
+ARITH_PAIRS(ARITH_KERNEL, AVX2, avx2_sub, -, long)
+ARITH_PAIRS(ARITH_KERNEL, AVX2, avx2_mul, *, long)
+ARITH_PAIRS(ARITH_KERNEL, AVX2, avx2_div, /, double)
+
+// indexed by operator, then left * 4 + right
+static const ArithKernels scalar_kernels[4][16] = {
+    {ARITH_PAIRS(ARITH_ENTRY, , scalar_add, +, long)},
+    {ARITH_PAIRS(ARITH_ENTRY, , scalar_sub, -, long)},
+    {ARITH_PAIRS(ARITH_ENTRY, , scalar_mul, *, long)},
+    {ARITH_PAIRS(ARITH_ENTRY, , scalar_div, /, double)},
+};
+
+static const ArithKernels avx2_kernels[4][16] = {
+    {ARITH_PAIRS(ARITH_ENTRY, , avx2_add, +, long)},
+    {ARITH_PAIRS(ARITH_ENTRY, , avx2_sub, -, long)},
+    {ARITH_PAIRS(ARITH_ENTRY, , avx2_mul, *, long)},
+    {ARITH_PAIRS(ARITH_ENTRY, , avx2_div, /, double)},
+};
+
+static pthread_once_t arith_once = PTHREAD_ONCE_INIT;
+static const ArithKernels (*arith_kernels)[16] = scalar_kernels;
+
+static void arith_init(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        arith_kernels = avx2_kernels;
+    }
+}
+
+static int arith_index(AggregateType op)
+{
+    switch (op)
+    {
+    case ADD:
+        return 0;
+    case SUB:
+        return 1;
+    case MUL:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+DataType arith_type(AggregateType op, DataType left, DataType right)
+{
+    if (left == DOUBLE || right == DOUBLE)
+        return DOUBLE;
+    if (left == FLOAT || right == FLOAT)
+        return FLOAT;
+    return op == DIV ? DOUBLE : LONG;
+}
+
+typedef struct MorselArith
+{
+    ArithKernel kernel;
+    const void *left;
+    const void *right;
+    void *out;
+} MorselArith;
+
+static void arith_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    (void)morsel;
+    MorselArith *task = (MorselArith *)arg;
+    task->kernel(task->left, task->right, task->out, start, end);
+}
+
+void arith(AggregateType op, ArithOperand left, ArithOperand right, void *out, size_t length)
+{
+    pthread_once(&arith_once, arith_init);
+    const ArithKernels *kernels = &arith_kernels[arith_index(op)][left.data_type * 4 + right.data_type];
+    ArithKernel kernel = left.scalar ? kernels->sv : right.scalar ? kernels->vs : kernels->vv;
+    if (length < PARALLEL_ARITH_THRESHOLD)
+    {
+        kernel(left.data, right.data, out, 0, length);
+        return;
+    }
+    MorselArith task = {kernel, left.data, right.data, out};
+    run_morsels(length, MORSEL_SIZE, &arith_morsel, &task);
+}
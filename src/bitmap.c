@@ -0,0 +1,119 @@
+#include <string.h>
+
+#include "bitmap.h"
+
+size_t bitmap_words(size_t num_rows)
+{
+    return (num_rows + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+}
+
+size_t bitmap_to_positions(const uint64_t *bits, size_t num_rows, size_t *out)
+{
+    size_t k = 0;
+    size_t num_words = bitmap_words(num_rows);
+    for (size_t w = 0; w < num_words; w++)
+    {
+        uint64_t word = bits[w];
+        size_t base = w * BITMAP_WORD_BITS;
+        while (word)
+        {
+            out[k++] = base + __builtin_ctzll(word);
+            word &= word - 1;
+        }
+    }
+    return k;
+}
+
+size_t bitmap_fetch(const uint64_t *bits, size_t num_rows, const int *data, int *out)
+{
+    size_t k = 0;
+    size_t num_words = bitmap_words(num_rows);
+    for (size_t w = 0; w < num_words; w++)
+    {
+        uint64_t word = bits[w];
+        size_t base = w * BITMAP_WORD_BITS;
+        if (word == UINT64_MAX)
+        {
+            // a full word is a contiguous run of 64 rows
+            memcpy(out + k, data + base, BITMAP_WORD_BITS * sizeof(int));
+            k += BITMAP_WORD_BITS;
+            continue;
+        }
+        while (word)
+        {
+            out[k++] = data[base + __builtin_ctzll(word)];
+            word &= word - 1;
+        }
+    }
+    return k;
+}
+
+size_t bitmap_sum(const uint64_t *bits, size_t num_rows)
+{
+    size_t sum = 0;
+    size_t num_words = bitmap_words(num_rows);
+    for (size_t w = 0; w < num_words; w++)
+    {
+        uint64_t word = bits[w];
+        size_t base = w * BITMAP_WORD_BITS;
+        // every set bit contributes base, plus its offset within the word
+        sum += base * __builtin_popcountll(word);
+        while (word)
+        {
+            sum += __builtin_ctzll(word);
+            word &= word - 1;
+        }
+    }
+    return sum;
+}
+
+size_t bitmap_and(const uint64_t *a, const uint64_t *b, size_t num_rows, uint64_t *out)
+{
+    size_t count = 0;
+    size_t num_words = bitmap_words(num_rows);
+    for (size_t w = 0; w < num_words; w++)
+    {
+        out[w] = a[w] & b[w];
+        count += __builtin_popcountll(out[w]);
+    }
+    return count;
+}
+
+size_t bitmap_or(const uint64_t *a, const uint64_t *b, size_t num_rows, uint64_t *out)
+{
+    size_t count = 0;
+    size_t num_words = bitmap_words(num_rows);
+    for (size_t w = 0; w < num_words; w++)
+    {
+        out[w] = a[w] | b[w];
+        count += __builtin_popcountll(out[w]);
+    }
+    return count;
+}
+
+bool bitmap_first(const uint64_t *bits, size_t num_rows, size_t *position)
+{
+    size_t num_words = bitmap_words(num_rows);
+    for (size_t w = 0; w < num_words; w++)
+    {
+        if (bits[w])
+        {
+            *position = w * BITMAP_WORD_BITS + __builtin_ctzll(bits[w]);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool bitmap_last(const uint64_t *bits, size_t num_rows, size_t *position)
+{
+    for (size_t w = bitmap_words(num_rows); w > 0; w--)
+    {
+        if (bits[w - 1])
+        {
+            *position = (w - 1) * BITMAP_WORD_BITS + (BITMAP_WORD_BITS - 1 - __builtin_clzll(bits[w - 1]));
+            return true;
+        }
+    }
+    return false;
+}
@@ -140,6 +140,26 @@ int binary_search_index(int *values, int n, int value)
     return high;
 }
 
+size_t lower_bound_index(const int *values, size_t n, long value)
+{
+    // index of the first value that is greater or equal to value, n if there is none
+    size_t low = 0;
+    size_t high = n;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (values[middle] < value)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
 int search_index(BTNode *root, int value)
 {
     // given a root b-tree node, search for the position associated with the target value
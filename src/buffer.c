@@ -0,0 +1,128 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer.h"
+
+static size_t *chunk_pool[CHUNK_POOL_SIZE];
+static size_t pooled_chunks = 0;
+static pthread_mutex_t chunk_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+size_t *acquire_chunk(void)
+{
+    size_t *chunk = NULL;
+    pthread_mutex_lock(&chunk_pool_mutex);
+    if (pooled_chunks > 0)
+        chunk = chunk_pool[--pooled_chunks];
+    pthread_mutex_unlock(&chunk_pool_mutex);
+    return chunk ? chunk : malloc(CHUNK_SIZE * sizeof(size_t));
+}
+
+void release_chunk(size_t *chunk)
+{
+    pthread_mutex_lock(&chunk_pool_mutex);
+    if (pooled_chunks < CHUNK_POOL_SIZE)
+    {
+        chunk_pool[pooled_chunks++] = chunk;
+        chunk = NULL;
+    }
+    pthread_mutex_unlock(&chunk_pool_mutex);
+    free(chunk);
+}
+
+void position_buffer_init(PositionBuffer *buffer, size_t estimate)
+{
+    // an eighth of slack absorbs estimation error without a regrow
+    buffer->capacity = estimate + estimate / 8;
+    if (buffer->capacity < MIN_BUFFER_SIZE)
+        buffer->capacity = MIN_BUFFER_SIZE;
+    buffer->length = 0;
+    buffer->data = malloc(buffer->capacity * sizeof(size_t));
+}
+
+size_t *position_buffer_reserve(PositionBuffer *buffer, size_t n)
+{
+    if (buffer->length + n > buffer->capacity)
+    {
+        buffer->capacity *= 2;
+        if (buffer->capacity < buffer->length + n)
+            buffer->capacity = buffer->length + n;
+        buffer->data = realloc(buffer->data, buffer->capacity * sizeof(size_t));
+    }
+    return buffer->data + buffer->length;
+}
+
+void position_buffer_append(PositionBuffer *buffer, const size_t *positions, size_t n)
+{
+    memcpy(position_buffer_reserve(buffer, n), positions, n * sizeof(size_t));
+    buffer->length += n;
+}
+
+size_t *position_buffer_finish(PositionBuffer *buffer)
+{
+    size_t *data = buffer->data;
+    // trim only when it frees a meaningful amount, realloc may copy
+    if (buffer->capacity - buffer->length > buffer->capacity / 8 + MIN_BUFFER_SIZE)
+        data = realloc(data, (buffer->length > 0 ? buffer->length : 1) * sizeof(size_t));
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    return data;
+}
+
+void morsel_positions_init(MorselPositions *outputs, size_t length)
+{
+    outputs->morsels = num_morsels(length, MORSEL_SIZE);
+    outputs->slices = malloc(outputs->morsels * sizeof(size_t *));
+    outputs->counts = malloc(outputs->morsels * sizeof(size_t));
+}
+
+void morsel_positions_keep(MorselPositions *outputs, size_t morsel, size_t *chunk, size_t count)
+{
+    outputs->counts[morsel] = count;
+    outputs->slices[morsel] = chunk;
+    // an empty morsel has nothing to copy, its chunk goes straight back to the pool
+    if (count == 0)
+    {
+        release_chunk(chunk);
+        outputs->slices[morsel] = NULL;
+    }
+}
+
+typedef struct MorselGather
+{
+    MorselPositions *outputs;
+    size_t *offsets;
+    size_t *out;
+} MorselGather;
+
+static void gather_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    (void)start;
+    (void)end;
+    MorselGather *gather = (MorselGather *)arg;
+    size_t count = gather->outputs->counts[morsel];
+    if (count == 0)
+        return;
+    memcpy(gather->out + gather->offsets[morsel], gather->outputs->slices[morsel], count * sizeof(size_t));
+    release_chunk(gather->outputs->slices[morsel]);
+}
+
+size_t morsel_positions_gather(MorselPositions *outputs, PositionBuffer *buffer)
+{
+    // a prefix sum over the morsel counts gives each chunk its offset, then they are copied in parallel
+    MorselGather gather = {outputs, malloc(outputs->morsels * sizeof(size_t)), NULL};
+    size_t total = 0;
+    for (size_t m = 0; m < outputs->morsels; m++)
+    {
+        gather.offsets[m] = total;
+        total += outputs->counts[m];
+    }
+    gather.out = position_buffer_reserve(buffer, total);
+    run_morsels(outputs->morsels, 1, &gather_morsel, &gather);
+    buffer->length += total;
+    free(gather.offsets);
+    free(outputs->slices);
+    free(outputs->counts);
+    return total;
+}
@@ -1,4 +1,8 @@
 #include "client_context.h"
+#include "bitmap.h"
+#include "pipeline.h"
+#include "ranges.h"
+#include "persist.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -19,25 +23,92 @@ GeneralizedColumnHandle* create_column_handle(char* name) {
     return handle;
 }
 
+void free_result(Result* result) {
+    if (result->format == DEFERRED) {
+        pipeline_release(result->payload);
+    } else if (result->format == VIEW) {
+        // the values belong to the column, only the reference to its mapping is dropped
+        release_mapping(result->mapping);
+    } else {
+        free(result->payload);
+    }
+    free(result);
+}
+
 void free_column_handle(GeneralizedColumnHandle* handle) {
     // free(handle->generalized_column); // TODO: how to free a generalized column?
     if (handle->generalized_column.column_type == RESULT) {
-        free(handle->generalized_column.column_pointer.result->payload);
-        free(handle->generalized_column.column_pointer.result);
-    }
-        // TODO: check how to free column
-    else {
-        free(handle->generalized_column.column_pointer.column->data);
-        free(handle->generalized_column.column_pointer.column);
+        free_result(handle->generalized_column.column_pointer.result);
     }
+    // a column handle borrows the catalog's column, its mapped data is not ours to free
     free(handle);
 }
 
+// converts a result held in a compact format into a plain array of its values, in place
+void materialize_result(Result* result) {
+    materialize_results(&result, 1);
+}
+
+// same as materialize_result for several results at once
+void materialize_results(Result** results, size_t num_results) {
+    evaluate_results(results, num_results);
+    for (size_t i = 0; i < num_results; i++) {
+        if (results[i]->format == BITMAP) {
+            size_t* positions = malloc(results[i]->num_tuples * sizeof(size_t));
+            bitmap_to_positions(results[i]->payload, results[i]->num_rows, positions);
+            free(results[i]->payload);
+            results[i]->payload = positions;
+            results[i]->format = MATERIALIZED;
+        } else if (results[i]->format == RANGES) {
+            size_t* positions = malloc(results[i]->num_tuples * sizeof(size_t));
+            ranges_to_positions(results[i]->payload, results[i]->num_ranges, positions);
+            free(results[i]->payload);
+            results[i]->payload = positions;
+            results[i]->format = MATERIALIZED;
+        }
+    }
+}
+
+// evaluates deferred results in place, deferred results driven by the same scan in one pass
+void evaluate_results(Result** results, size_t num_results) {
+    PipelineNode** targets = malloc(num_results * sizeof(PipelineNode*));
+    Result** deferred = malloc(num_results * sizeof(Result*));
+    Result** evaluated = malloc(num_results * sizeof(Result*));
+    for (size_t i = 0; i < num_results; i++) {
+        if (results[i]->format == DEFERRED) {
+            PipelineNode* source = ((PipelineNode*) results[i]->payload)->source;
+            size_t num_targets = 0;
+            for (size_t j = i; j < num_results; j++) {
+                bool listed = false;
+                for (size_t k = 0; k < num_targets; k++) {
+                    listed |= deferred[k] == results[j];
+                }
+                if (!listed && results[j]->format == DEFERRED && ((PipelineNode*) results[j]->payload)->source == source) {
+                    deferred[num_targets] = results[j];
+                    targets[num_targets++] = results[j]->payload;
+                }
+            }
+            pipeline_run(targets, num_targets, evaluated);
+            for (size_t k = 0; k < num_targets; k++) {
+                pipeline_release(targets[k]);
+                *deferred[k] = *evaluated[k];
+                free(evaluated[k]);
+            }
+        }
+    }
+    free(targets);
+    free(deferred);
+    free(evaluated);
+}
+
 void allocate(ClientContext** context, size_t size) {
     *context = malloc(sizeof(struct ClientContext));
     ClientContext* context_pointer = *context;
     context_pointer->chandle_slots = size;
     context_pointer->chandles_in_use = 0;
+    context_pointer->batch_queries = NULL;
+    context_pointer->num_batch_queries = 0;
+    context_pointer->batch_capacity = 0;
     context_pointer->chandle_table = malloc(size * sizeof(GeneralizedColumnHandle*));
     for (int i = 0; i < context_pointer->chandle_slots; i++) {
         context_pointer->chandle_table[i] = NULL;
@@ -133,13 +204,7 @@ void add_context(Result* result, ClientContext* client_context, char* name) {
             if (strcmp(root->name, name) == 0) {
                 // free memory
                 if (root->generalized_column.column_type == RESULT) {
-                    free(root->generalized_column.column_pointer.result->payload);
-                    free(root->generalized_column.column_pointer.result);
-                }
-                // TODO: check how to free column
-                else if (root->generalized_column.column_type == COLUMN) {
-                    free(root->generalized_column.column_pointer.column->data);
-                    free(root->generalized_column.column_pointer.column);
+                    free_result(root->generalized_column.column_pointer.result);
                 }
                 break;
             }
@@ -179,6 +244,7 @@ void deallocate(ClientContext* client_context) {
             free(prev);
         }
     }
+    free(client_context->batch_queries);
     free(client_context->chandle_table);
     free(client_context);
 }
\ No newline at end of file
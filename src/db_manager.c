@@ -1,15 +1,18 @@
 #include <string.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include "cs165_api.h"
+#include "scan.h"
 #include "message.h"
 #include "utils.h"
 #include "common.h"
 #include "persist.h"
 #include "btree.h"
+#include "reduce.h"
 
 #define DB_MAX_TABLE_CAPACITY 16
 #define TABLE_INIT_LENGTH_CAPACITY 1000000
@@ -133,6 +136,11 @@ Column *create_column(Table *table, char *name, Status *ret_status)
 	column->clustered = false;
 	column->sorted = false;
 	column->btree_root = NULL;
+	column->index = NULL;
+	column->histogram = NULL;
+	column->zone_map = NULL;
+	column->mapping = NULL;
+	reset_column_stats(column);
 	// set return status code and message
 	ret_status->code = OK;
 	return NULL;
@@ -195,6 +203,54 @@ SelectType optimize(Column *column, int low, int high)
 	}
 }
 
+/*
+ * estimate the fraction of rows in [low, high]: from the histogram of indexed columns,
+ * otherwise from an evenly strided sample of the column
+ */
+double estimate_selectivity(Column *column, int low, int high)
+{
+	if (column->length == 0 || low > high)
+		return 0;
+	Histogram *hist = column->histogram;
+	if (hist)
+	{
+		// bin i holds the values in (values[i - 1], values[i]], bin 0 only the minimum
+		double count = 0;
+		size_t binned = 0;
+		for (int i = 0; i < NUM_BINS; i++)
+		{
+			long bin_low = i == 0 ? hist->values[0] : (long)hist->values[i - 1] + 1;
+			long bin_high = hist->values[i];
+			binned += hist->counts[i];
+			long overlap_low = bin_low > low ? bin_low : low;
+			long overlap_high = bin_high < high ? bin_high : high;
+			if (overlap_low <= overlap_high)
+				count += hist->counts[i] * (double)(overlap_high - overlap_low + 1) / (bin_high - bin_low + 1);
+		}
+		// values above the last bin are not binned
+		if (high > hist->values[NUM_BINS - 1])
+			count += column->length - binned;
+		return count / column->length;
+	}
+	size_t step = column->length / SELECTIVITY_SAMPLE_SIZE + 1;
+	size_t sampled = 0;
+	size_t hits = 0;
+	for (size_t i = 0; i < column->length; i += step)
+	{
+		hits += (column->data[i] >= low) & (column->data[i] <= high);
+		sampled++;
+	}
+	return hits * 1.0 / sampled;
+}
+
+/*
+ * select positions are emitted as a bitmap when enough rows qualify, as a sorted array otherwise
+ */
+ResultFormat choose_position_format(Column *column, int low, int high)
+{
+	return estimate_selectivity(column, low, high) >= BITMAP_SELECTIVITY_THRES ? BITMAP : MATERIALIZED;
+}
+
 /*
  * create a index
  */
@@ -360,4 +416,113 @@ void build_secondary_index(Column *primary_column, bool btree)
 		primary_column->btree_root = create_btree(primary_column->index->values, positions, primary_column->length);
 		free(positions);
 	}
-}
\ No newline at end of file
+}
+/*
+ * (re)build the zone map of a column from its data
+ */
+void build_zone_map(Column *column)
+{
+	size_t num_zones = (column->length + ZONE_SIZE - 1) / ZONE_SIZE;
+	if (!column->zone_map)
+	{
+		column->zone_map = calloc(1, sizeof(ZoneMap));
+	}
+	ZoneMap *zone_map = column->zone_map;
+	if (num_zones > zone_map->capacity)
+	{
+		zone_map->capacity = num_zones;
+		zone_map->min = realloc(zone_map->min, zone_map->capacity * sizeof(int));
+		zone_map->max = realloc(zone_map->max, zone_map->capacity * sizeof(int));
+	}
+	zone_map->num_zones = num_zones;
+	for (size_t zone = 0; zone < num_zones; zone++)
+	{
+		size_t start = zone * ZONE_SIZE;
+		size_t end = start + ZONE_SIZE < column->length ? start + ZONE_SIZE : column->length;
+		int min = column->data[start];
+		int max = column->data[start];
+		for (size_t i = start + 1; i < end; i++)
+		{
+			min = column->data[i] < min ? column->data[i] : min;
+			max = column->data[i] > max ? column->data[i] : max;
+		}
+		zone_map->min[zone] = min;
+		zone_map->max[zone] = max;
+	}
+}
+
+/*
+ * widen the zone holding the value just written at position, opening a new zone if needed
+ */
+void update_zone_map(Column *column, size_t position)
+{
+	if (!column->zone_map)
+	{
+		column->zone_map = calloc(1, sizeof(ZoneMap));
+	}
+	ZoneMap *zone_map = column->zone_map;
+	size_t zone = position / ZONE_SIZE;
+	int value = column->data[position];
+	if (zone >= zone_map->num_zones)
+	{
+		if (zone >= zone_map->capacity)
+		{
+			zone_map->capacity = zone_map->capacity ? zone_map->capacity * 2 : 1;
+			if (zone >= zone_map->capacity)
+				zone_map->capacity = zone + 1;
+			zone_map->min = realloc(zone_map->min, zone_map->capacity * sizeof(int));
+			zone_map->max = realloc(zone_map->max, zone_map->capacity * sizeof(int));
+		}
+		zone_map->num_zones = zone + 1;
+		zone_map->min[zone] = value;
+		zone_map->max[zone] = value;
+		return;
+	}
+	zone_map->min[zone] = value < zone_map->min[zone] ? value : zone_map->min[zone];
+	zone_map->max[zone] = value > zone_map->max[zone] ? value : zone_map->max[zone];
+}
+
+void free_zone_map(Column *column)
+{
+	if (column->zone_map)
+	{
+		free(column->zone_map->min);
+		free(column->zone_map->max);
+		free(column->zone_map);
+		column->zone_map = NULL;
+	}
+}
+
+/*
+ * empty the statistics of a column: min and max start at the sentinels every value beats
+ */
+void reset_column_stats(Column *column)
+{
+	column->stats.count = 0;
+	column->stats.sum = 0;
+	column->stats.min = INT_MAX;
+	column->stats.max = -INT_MAX - 1;
+	column->stats.tombstones = 0;
+}
+
+/*
+ * (re)build the statistics of a column from its data
+ */
+void build_column_stats(Column *column)
+{
+	reset_column_stats(column);
+	column->stats.count = column->length;
+	column->stats.sum = parallel_sum_int(column->data, column->length);
+	parallel_minmax_int(column->data, column->length, &column->stats.min, &column->stats.max);
+}
+
+/*
+ * fold a value appended to the column into its statistics
+ */
+void update_column_stats(Column *column, int value)
+{
+	column->stats.count++;
+	column->stats.sum += value;
+	column->stats.min = value < column->stats.min ? value : column->stats.min;
+	column->stats.max = value > column->stats.max ? value : column->stats.max;
+}
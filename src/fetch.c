@@ -0,0 +1,201 @@
+#include <string.h>
+#include <pthread.h>
+#include <immintrin.h>
+
+#include "fetch.h"
+
+static pthread_once_t fetch_once = PTHREAD_ONCE_INIT;
+static fetch_gather_fn fetch_gather_impl = fetch_gather_scalar;
+
+static void fetch_init(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        fetch_gather_impl = fetch_gather_avx2;
+    }
+}
+
+void fetch_gather_scalar(const int *data, const size_t *positions, size_t start, size_t end, bool prefetch, int *out)
+{
+    size_t i = start;
+    if (prefetch && end - start > FETCH_PREFETCH_DISTANCE)
+    {
+        for (; i < end - FETCH_PREFETCH_DISTANCE; i++)
+        {
+            __builtin_prefetch(&data[positions[i + FETCH_PREFETCH_DISTANCE]]);
+            out[i] = data[positions[i]];
+        }
+    }
+    for (; i < end; i++)
+    {
+        out[i] = data[positions[i]];
+    }
+}
+
+__attribute__((target("avx2"))) void fetch_gather_avx2(const int *data, const size_t *positions, size_t start, size_t end, bool prefetch, int *out)
+{
+    size_t i = start;
+    if (prefetch && end - start > FETCH_PREFETCH_DISTANCE + 4)
+    {
+        for (; i + 4 <= end - FETCH_PREFETCH_DISTANCE; i += 4)
+        {
+            const size_t *ahead = positions + i + FETCH_PREFETCH_DISTANCE;
+            __builtin_prefetch(&data[ahead[0]]);
+            __builtin_prefetch(&data[ahead[1]]);
+            __builtin_prefetch(&data[ahead[2]]);
+            __builtin_prefetch(&data[ahead[3]]);
+            __m256i index = _mm256_loadu_si256((const __m256i *)(positions + i));
+            _mm_storeu_si128((__m128i *)(out + i), _mm256_i64gather_epi32(data, index, 4));
+        }
+    }
+    for (; i + 4 <= end; i += 4)
+    {
+        __m256i index = _mm256_loadu_si256((const __m256i *)(positions + i));
+        _mm_storeu_si128((__m128i *)(out + i), _mm256_i64gather_epi32(data, index, 4));
+    }
+    for (; i < end; i++)
+    {
+        out[i] = data[positions[i]];
+    }
+}
+
+void fetch_gather(const int *data, const size_t *positions, size_t start, size_t end, bool prefetch, int *out)
+{
+    pthread_once(&fetch_once, fetch_init);
+    fetch_gather_impl(data, positions, start, end, prefetch, out);
+}
+
+void fetch_runs(const int *data, const size_t *positions, size_t start, size_t end, int *out)
+{
+    size_t i = start;
+    while (i < end)
+    {
+        size_t run = i + 1;
+        while (run < end && positions[run] == positions[run - 1] + 1)
+        {
+            run++;
+        }
+        if (run - i >= MIN_MEMCPY_RUN)
+        {
+            memcpy(out + i, data + positions[i], (run - i) * sizeof(int));
+        }
+        else
+        {
+            for (size_t j = i; j < run; j++)
+                out[j] = data[positions[j]];
+        }
+        i = run;
+    }
+}
+
+typedef enum FetchPattern
+{
+    FETCH_RANDOM,   // random order: every row is a likely cache miss
+    FETCH_RUNS,     // ascending runs of consecutive rows
+    FETCH_SPARSE,   // ascending rows several cache lines apart, which defeat the hardware prefetcher
+    FETCH_DENSE,    // ascending rows close enough for the hardware prefetcher
+} FetchPattern;
+
+// every kernel is correct for any positions, the sample only decides which one is fastest
+static FetchPattern sample_positions(const size_t *positions, size_t start, size_t end)
+{
+    size_t sample_end = end - start > FETCH_SAMPLE ? start + FETCH_SAMPLE : end;
+    size_t runs = 1;
+    for (size_t i = start + 1; i < sample_end; i++)
+    {
+        if (positions[i] < positions[i - 1])
+            return FETCH_RANDOM;
+        runs += positions[i] != positions[i - 1] + 1;
+    }
+    size_t count = sample_end - start;
+    size_t span = positions[sample_end - 1] - positions[start] + 1;
+    if (count >= MIN_MEMCPY_RUN * runs)
+        return FETCH_RUNS;
+    return span >= CACHE_LINE_INTS * count ? FETCH_SPARSE : FETCH_DENSE;
+}
+
+static void fetch_pattern(FetchPattern pattern, const int *data, const size_t *positions, size_t start, size_t end, int *out)
+{
+    if (pattern == FETCH_RUNS)
+        fetch_runs(data, positions, start, end, out);
+    else
+        fetch_gather(data, positions, start, end, pattern != FETCH_DENSE, out);
+}
+
+void fetch_positions(const int *data, const size_t *positions, size_t start, size_t end, int *out)
+{
+    if (start == end)
+        return;
+    fetch_pattern(sample_positions(positions, start, end), data, positions, start, end, out);
+}
+
+void fetch_gather_columns(const int *const *columns, size_t num_columns, const size_t *positions, size_t start, size_t end, int *const *outs)
+{
+    size_t i = start;
+    if (end - start > FETCH_PREFETCH_DISTANCE)
+    {
+        for (; i < end - FETCH_PREFETCH_DISTANCE; i++)
+        {
+            size_t ahead = positions[i + FETCH_PREFETCH_DISTANCE];
+            size_t row = positions[i];
+            for (size_t c = 0; c < num_columns; c++)
+            {
+                __builtin_prefetch(&columns[c][ahead]);
+                outs[c][i] = columns[c][row];
+            }
+        }
+    }
+    for (; i < end; i++)
+    {
+        size_t row = positions[i];
+        for (size_t c = 0; c < num_columns; c++)
+            outs[c][i] = columns[c][row];
+    }
+}
+
+void fetch_positions_columns(const int *const *columns, size_t num_columns, const size_t *positions, size_t start, size_t end, int *const *outs)
+{
+    if (start == end)
+        return;
+    if (num_columns == 1)
+    {
+        fetch_positions(columns[0], positions, start, end, outs[0]);
+        return;
+    }
+    FetchPattern pattern = sample_positions(positions, start, end);
+    if (pattern == FETCH_RANDOM || pattern == FETCH_SPARSE)
+    {
+        fetch_gather_columns(columns, num_columns, positions, start, end, outs);
+        return;
+    }
+    // runs and dense rows stream well column by column, the positions stay cached between columns
+    for (size_t c = 0; c < num_columns; c++)
+        fetch_pattern(pattern, columns[c], positions, start, end, outs[c]);
+}
+
+typedef struct MorselFetchColumns
+{
+    const int *const *columns;
+    size_t num_columns;
+    const size_t *positions;
+    int *const *outs;
+} MorselFetchColumns;
+
+static void fetch_columns_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    (void)morsel;
+    MorselFetchColumns *fetch = (MorselFetchColumns *)arg;
+    fetch_positions_columns(fetch->columns, fetch->num_columns, fetch->positions, start, end, fetch->outs);
+}
+
+void parallel_fetch_columns(const int *const *columns, size_t num_columns, const size_t *positions, size_t length, int *const *outs)
+{
+    if (length < PARALLEL_FETCH_THRESHOLD)
+    {
+        fetch_positions_columns(columns, num_columns, positions, 0, length, outs);
+        return;
+    }
+    MorselFetchColumns fetch = {columns, num_columns, positions, outs};
+    run_morsels(length, MORSEL_SIZE, &fetch_columns_morsel, &fetch);
+}
@@ -0,0 +1,494 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <immintrin.h>
+
+#include "groupby.h"
+#include "morsel.h"
+#include "reduce.h"
+
+// smallest table, a few cache lines of entries
+#define MIN_GROUP_TABLE 64
+
+typedef struct GroupTable
+{
+    GroupEntry *entries;
+    size_t capacity; // power of two
+    size_t size;
+} GroupTable;
+
+typedef struct GroupInput
+{
+    const void *keys;
+    DataType key_type;
+    const void *values;
+    DataType value_type;
+    bool floating;
+} GroupInput;
+
+// murmur3 finalizer: the high bits pick the partition, the low bits the slot
+static inline uint64_t hash_key(long key)
+{
+    uint64_t h = (uint64_t)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline size_t partition_of(long key)
+{
+    return hash_key(key) >> (64 - GROUP_PARTITION_BITS);
+}
+
+static inline long key_at(const GroupInput *input, size_t i)
+{
+    return input->key_type == INT ? ((const int *)input->keys)[i] : ((const long *)input->keys)[i];
+}
+
+static inline GroupValue value_at(const GroupInput *input, size_t i)
+{
+    GroupValue value;
+    if (input->value_type == INT)
+        value.i = ((const int *)input->values)[i];
+    else if (input->value_type == LONG)
+        value.i = ((const long *)input->values)[i];
+    else if (input->value_type == FLOAT)
+        value.f = ((const float *)input->values)[i];
+    else
+        value.f = ((const double *)input->values)[i];
+    return value;
+}
+
+static void group_table_init(GroupTable *table, size_t groups)
+{
+    table->capacity = MIN_GROUP_TABLE;
+    while (table->capacity < 2 * groups)
+        table->capacity *= 2;
+    table->size = 0;
+    table->entries = calloc(table->capacity, sizeof(GroupEntry));
+}
+
+static void group_table_grow(GroupTable *table);
+
+// the entry of key, claimed with count 0 when the key is new
+static GroupEntry *group_table_find(GroupTable *table, long key)
+{
+    size_t mask = table->capacity - 1;
+    size_t slot = hash_key(key) & mask;
+    // linear probing: a miss walks consecutive entries of the same few cache lines
+    while (table->entries[slot].count != 0 && table->entries[slot].key != key)
+        slot = (slot + 1) & mask;
+    if (table->entries[slot].count == 0)
+    {
+        if (2 * (table->size + 1) > table->capacity)
+        {
+            group_table_grow(table);
+            return group_table_find(table, key);
+        }
+        table->entries[slot].key = key;
+        table->size++;
+    }
+    return &table->entries[slot];
+}
+
+static void group_table_grow(GroupTable *table)
+{
+    GroupTable grown;
+    grown.capacity = 2 * table->capacity;
+    grown.size = table->size;
+    grown.entries = calloc(grown.capacity, sizeof(GroupEntry));
+    size_t mask = grown.capacity - 1;
+    for (size_t s = 0; s < table->capacity; s++)
+    {
+        if (table->entries[s].count == 0)
+            continue;
+        size_t slot = hash_key(table->entries[s].key) & mask;
+        while (grown.entries[slot].count != 0)
+            slot = (slot + 1) & mask;
+        grown.entries[slot] = table->entries[s];
+    }
+    free(table->entries);
+    *table = grown;
+}
+
+static inline void group_add(GroupEntry *entry, GroupValue value, bool floating)
+{
+    if (entry->count++ == 0)
+    {
+        entry->sum = entry->min = entry->max = value;
+    }
+    else if (floating)
+    {
+        entry->sum.f += value.f;
+        entry->min.f = value.f < entry->min.f ? value.f : entry->min.f;
+        entry->max.f = value.f > entry->max.f ? value.f : entry->max.f;
+    }
+    else
+    {
+        entry->sum.i += value.i;
+        entry->min.i = value.i < entry->min.i ? value.i : entry->min.i;
+        entry->max.i = value.i > entry->max.i ? value.i : entry->max.i;
+    }
+}
+
+static void group_merge(GroupEntry *entry, const GroupEntry *partial, bool floating)
+{
+    if (entry->count == 0)
+    {
+        *entry = *partial;
+        return;
+    }
+    entry->count += partial->count;
+    if (floating)
+    {
+        entry->sum.f += partial->sum.f;
+        entry->min.f = partial->min.f < entry->min.f ? partial->min.f : entry->min.f;
+        entry->max.f = partial->max.f > entry->max.f ? partial->max.f : entry->max.f;
+    }
+    else
+    {
+        entry->sum.i += partial->sum.i;
+        entry->min.i = partial->min.i < entry->min.i ? partial->min.i : entry->min.i;
+        entry->max.i = partial->max.i > entry->max.i ? partial->max.i : entry->max.i;
+    }
+}
+
+typedef struct MorselGroup
+{
+    const GroupInput *input;
+    GroupTable *tables; // one per morsel, or per partition
+    size_t *offsets;    // partitioned: morsel-major scatter cursors, morsels x GROUP_PARTITIONS
+    size_t *bounds;     // partitioned: first row of every partition, GROUP_PARTITIONS + 1
+    long *keys;         // partitioned: rows in partition order
+    GroupValue *values;
+    size_t length;      // sorted: rows of the input, a run may continue past its morsel
+} MorselGroup;
+
+// thread-local partial aggregation of one morsel
+static void group_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MorselGroup *group = (MorselGroup *)arg;
+    const GroupInput *input = group->input;
+    GroupTable *table = &group->tables[morsel];
+    group_table_init(table, MIN_GROUP_TABLE);
+    for (size_t i = start; i < end; i++)
+        group_add(group_table_find(table, key_at(input, i)), value_at(input, i), input->floating);
+}
+
+static void count_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MorselGroup *group = (MorselGroup *)arg;
+    size_t *counts = group->offsets + morsel * GROUP_PARTITIONS;
+    for (size_t i = start; i < end; i++)
+        counts[partition_of(key_at(group->input, i))]++;
+}
+
+static void scatter_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MorselGroup *group = (MorselGroup *)arg;
+    size_t *cursors = group->offsets + morsel * GROUP_PARTITIONS;
+    for (size_t i = start; i < end; i++)
+    {
+        long key = key_at(group->input, i);
+        size_t c = cursors[partition_of(key)]++;
+        group->keys[c] = key;
+        group->values[c] = value_at(group->input, i);
+    }
+}
+
+// one partition per morsel: its groups are disjoint from every other partition's
+static void group_partition(void *arg, size_t partition, size_t start, size_t end)
+{
+    (void)start;
+    (void)end;
+    MorselGroup *group = (MorselGroup *)arg;
+    GroupTable *table = &group->tables[partition];
+    group_table_init(table, MIN_GROUP_TABLE);
+    for (size_t c = group->bounds[partition]; c < group->bounds[partition + 1]; c++)
+        group_add(group_table_find(table, group->keys[c]), group->values[c], group->input->floating);
+}
+
+// distinct keys among the first rows, to choose between per-morsel tables and partitioning
+static size_t sample_groups(const GroupInput *input, size_t length)
+{
+    GroupTable table;
+    group_table_init(&table, MIN_GROUP_TABLE);
+    size_t sample = length < MORSEL_SIZE ? length : MORSEL_SIZE;
+    for (size_t i = 0; i < sample && table.size <= GROUP_CACHE_GROUPS; i++)
+        group_table_find(&table, key_at(input, i))->count = 1;
+    size_t groups = table.size;
+    free(table.entries);
+    return groups;
+}
+
+static int group_cmp(const void *a, const void *b)
+{
+    long x = ((const GroupEntry *)a)->key;
+    long y = ((const GroupEntry *)b)->key;
+    return (x > y) - (x < y);
+}
+
+// moves the entries of the tables into one array sorted by key, frees the tables
+static size_t collect_groups(GroupTable *tables, size_t num_tables, GroupEntry **groups)
+{
+    size_t total = 0;
+    for (size_t t = 0; t < num_tables; t++)
+        total += tables[t].size;
+    GroupEntry *out = malloc((total > 0 ? total : 1) * sizeof(GroupEntry));
+    size_t k = 0;
+    for (size_t t = 0; t < num_tables; t++)
+    {
+        for (size_t s = 0; s < tables[t].capacity; s++)
+        {
+            if (tables[t].entries[s].count != 0)
+                out[k++] = tables[t].entries[s];
+        }
+        free(tables[t].entries);
+    }
+    qsort(out, total, sizeof(GroupEntry), group_cmp);
+    *groups = out;
+    return total;
+}
+
+static size_t group_by_morsels(const GroupInput *input, size_t length, GroupEntry **groups)
+{
+    size_t morsels = num_morsels(length, MORSEL_SIZE);
+    MorselGroup group = {input, malloc(morsels * sizeof(GroupTable)), NULL, NULL, NULL, NULL, length};
+    run_morsels(length, MORSEL_SIZE, &group_morsel, &group);
+    // partials are merged in morsel order, so float sums do not depend on scheduling
+    GroupTable merged = group.tables[0];
+    for (size_t m = 1; m < morsels; m++)
+    {
+        for (size_t s = 0; s < group.tables[m].capacity; s++)
+        {
+            if (group.tables[m].entries[s].count != 0)
+                group_merge(group_table_find(&merged, group.tables[m].entries[s].key), &group.tables[m].entries[s], input->floating);
+        }
+        free(group.tables[m].entries);
+    }
+    free(group.tables);
+    return collect_groups(&merged, 1, groups);
+}
+
+static size_t group_by_partitions(const GroupInput *input, size_t length, GroupEntry **groups)
+{
+    size_t morsels = num_morsels(length, MORSEL_SIZE);
+    MorselGroup group = {input, malloc(GROUP_PARTITIONS * sizeof(GroupTable)), calloc(morsels * GROUP_PARTITIONS, sizeof(size_t)),
+                         malloc((GROUP_PARTITIONS + 1) * sizeof(size_t)), malloc(length * sizeof(long)), malloc(length * sizeof(GroupValue)), length};
+    run_morsels(length, MORSEL_SIZE, &count_morsel, &group);
+    // partition-major prefix sum: every morsel scatters behind the earlier morsels of the same partition
+    size_t offset = 0;
+    for (size_t p = 0; p < GROUP_PARTITIONS; p++)
+    {
+        group.bounds[p] = offset;
+        for (size_t m = 0; m < morsels; m++)
+        {
+            size_t count = group.offsets[m * GROUP_PARTITIONS + p];
+            group.offsets[m * GROUP_PARTITIONS + p] = offset;
+            offset += count;
+        }
+    }
+    group.bounds[GROUP_PARTITIONS] = offset;
+    run_morsels(length, MORSEL_SIZE, &scatter_morsel, &group);
+    run_morsels(GROUP_PARTITIONS, 1, &group_partition, &group);
+    free(group.offsets);
+    free(group.bounds);
+    free(group.keys);
+    free(group.values);
+    size_t total = collect_groups(group.tables, GROUP_PARTITIONS, groups);
+    free(group.tables);
+    return total;
+}
+
+static size_t run_end_int_scalar(const int *keys, size_t start, size_t length)
+{
+    size_t i = start + 1;
+    while (i < length && keys[i] == keys[start])
+        i++;
+    return i;
+}
+
+static size_t run_end_long_scalar(const long *keys, size_t start, size_t length)
+{
+    size_t i = start + 1;
+    while (i < length && keys[i] == keys[start])
+        i++;
+    return i;
+}
+
+// compares 8 keys with the run's key per step, the first unequal lane is the boundary
+__attribute__((target("avx2"))) static size_t run_end_int_avx2(const int *keys, size_t start, size_t length)
+{
+    const __m256i key = _mm256_set1_epi32(keys[start]);
+    size_t i = start + 1;
+    for (; i + 8 <= length; i += 8)
+    {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(keys + i)), key);
+        unsigned mask = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(equal)) & 0xFF;
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    while (i < length && keys[i] == keys[start])
+        i++;
+    return i;
+}
+
+__attribute__((target("avx2"))) static size_t run_end_long_avx2(const long *keys, size_t start, size_t length)
+{
+    const __m256i key = _mm256_set1_epi64x(keys[start]);
+    size_t i = start + 1;
+    for (; i + 4 <= length; i += 4)
+    {
+        __m256i equal = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(keys + i)), key);
+        unsigned mask = ~(unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(equal)) & 0xF;
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    while (i < length && keys[i] == keys[start])
+        i++;
+    return i;
+}
+
+static size_t (*run_end_int)(const int *, size_t, size_t) = run_end_int_scalar;
+static size_t (*run_end_long)(const long *, size_t, size_t) = run_end_long_scalar;
+static pthread_once_t group_once = PTHREAD_ONCE_INIT;
+
+static void group_init(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        run_end_int = run_end_int_avx2;
+        run_end_long = run_end_long_avx2;
+    }
+}
+
+// first row after start whose key differs from the key at start
+static inline size_t run_end(const GroupInput *input, size_t start, size_t length)
+{
+    return input->key_type == INT ? run_end_int(input->keys, start, length) : run_end_long(input->keys, start, length);
+}
+
+// aggregates the run [start, end) into entry, long runs through the reduction kernels
+static void group_run(const GroupInput *input, size_t start, size_t end, GroupEntry *entry)
+{
+    entry->key = key_at(input, start);
+    entry->count = 0;
+    if (end - start < RUN_KERNEL_MIN)
+    {
+        for (size_t i = start; i < end; i++)
+            group_add(entry, value_at(input, i), input->floating);
+        return;
+    }
+    entry->count = end - start;
+    if (input->value_type == INT)
+    {
+        int min = ((const int *)input->values)[start], max = min;
+        minmax_int(input->values, start, end, &min, &max);
+        entry->sum.i = sum_int(input->values, start, end);
+        entry->min.i = min;
+        entry->max.i = max;
+    }
+    else if (input->value_type == LONG)
+    {
+        long min = ((const long *)input->values)[start], max = min;
+        minmax_long(input->values, start, end, &min, &max);
+        entry->sum.i = sum_long(input->values, start, end);
+        entry->min.i = min;
+        entry->max.i = max;
+    }
+    else if (input->value_type == FLOAT)
+    {
+        float min = ((const float *)input->values)[start], max = min;
+        minmax_float(input->values, start, end, &min, &max);
+        entry->sum.f = sum_float(input->values, start, end);
+        entry->min.f = min;
+        entry->max.f = max;
+    }
+    else
+    {
+        double min = ((const double *)input->values)[start], max = min;
+        minmax_double(input->values, start, end, &min, &max);
+        entry->sum.f = sum_double(input->values, start, end);
+        entry->min.f = min;
+        entry->max.f = max;
+    }
+}
+
+// the runs starting in [start, end); the run crossing start belongs to the morsel it started in
+static void run_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MorselGroup *group = (MorselGroup *)arg;
+    const GroupInput *input = group->input;
+    // the morsel's groups in run order, the table is used as a plain array
+    GroupTable *runs = &group->tables[morsel];
+    runs->capacity = MIN_GROUP_TABLE;
+    runs->size = 0;
+    runs->entries = malloc(runs->capacity * sizeof(GroupEntry));
+    size_t i = start;
+    if (start > 0 && key_at(input, start) == key_at(input, start - 1))
+        i = run_end(input, start, group->length);
+    while (i < end)
+    {
+        size_t next = run_end(input, i, group->length);
+        if (runs->size == runs->capacity)
+        {
+            runs->capacity *= 2;
+            runs->entries = realloc(runs->entries, runs->capacity * sizeof(GroupEntry));
+        }
+        group_run(input, i, next, &runs->entries[runs->size++]);
+        i = next;
+    }
+}
+
+static bool keys_sorted(const GroupInput *input, size_t length)
+{
+    for (size_t i = 1; i < length; i++)
+    {
+        if (key_at(input, i) < key_at(input, i - 1))
+            return false;
+    }
+    return true;
+}
+
+static size_t group_by_runs(const GroupInput *input, size_t length, GroupEntry **groups)
+{
+    pthread_once(&group_once, group_init);
+    size_t morsels = num_morsels(length, MORSEL_SIZE);
+    MorselGroup group = {input, malloc(morsels * sizeof(GroupTable)), NULL, NULL, NULL, NULL, length};
+    run_morsels(length, MORSEL_SIZE, &run_morsel, &group);
+    // every run is in exactly one morsel, so concatenating in morsel order keeps the keys ascending
+    size_t total = 0;
+    for (size_t m = 0; m < morsels; m++)
+        total += group.tables[m].size;
+    GroupEntry *out = malloc((total > 0 ? total : 1) * sizeof(GroupEntry));
+    size_t k = 0;
+    for (size_t m = 0; m < morsels; m++)
+    {
+        memcpy(out + k, group.tables[m].entries, group.tables[m].size * sizeof(GroupEntry));
+        k += group.tables[m].size;
+        free(group.tables[m].entries);
+    }
+    free(group.tables);
+    *groups = out;
+    return total;
+}
+
+size_t group_by(const void *keys, DataType key_type, const void *values, DataType value_type, size_t length, bool sorted, GroupEntry **groups)
+{
+    GroupInput input = {keys, key_type, values, value_type, value_type == FLOAT || value_type == DOUBLE};
+    if (length == 0)
+    {
+        *groups = malloc(sizeof(GroupEntry));
+        return 0;
+    }
+    if (sorted || keys_sorted(&input, length))
+        return group_by_runs(&input, length, groups);
+    if (sample_groups(&input, length) > GROUP_CACHE_GROUPS)
+        return group_by_partitions(&input, length, groups);
+    return group_by_morsels(&input, length, groups);
+}
@@ -0,0 +1,42 @@
+#ifndef ARITH_H__
+#define ARITH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cs165_api.h"
+#include "morsel.h"
+
+// elementwise operations shorter than this run on the calling thread
+#define PARALLEL_ARITH_THRESHOLD (4 * MORSEL_SIZE)
+
+// one side of an elementwise operation: a vector, or a single value broadcast to every row
+typedef struct ArithOperand
+{
+    const void *data;
+    DataType data_type;
+    bool scalar;
+} ArithOperand;
+
+/*
+ * Type an ADD, SUB, MUL or DIV of left and right is computed in: integers
+ * combine into LONG, anything with a DOUBLE into DOUBLE, the rest into FLOAT.
+ * Integer division is computed in DOUBLE.
+ */
+DataType arith_type(AggregateType op, DataType left, DataType right);
+
+/*
+ * out[i] = left[i] op right[i] over [0, length) for ADD, SUB, MUL and DIV,
+ * with both operands converted to arith_type first. out holds length values
+ * of that type and must not overlap either operand. A scalar operand is
+ * broadcast against the other; two scalars require length 1.
+ *
+ * The kernels for every operator, operand pair and broadcast form are
+ * generated from one macro, once plainly and once for AVX2 so the compiler
+ * vectorizes them with 256-bit registers; the widest the cpu supports is
+ * picked at first use. Inputs of PARALLEL_ARITH_THRESHOLD rows or more are
+ * split into morsels.
+ */
+void arith(AggregateType op, ArithOperand left, ArithOperand right, void *out, size_t length);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef BITMAP_H__
+#define BITMAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Position bitmaps: position i is present when bit i % 64 of word i / 64 is set.
+ * Words are visited in order and set bits are extracted lowest first, so every
+ * walk below yields positions in ascending order.
+ */
+#define BITMAP_WORD_BITS 64
+
+// number of words needed to cover num_rows positions
+size_t bitmap_words(size_t num_rows);
+
+// writes the set positions to out in ascending order, returns how many were written
+size_t bitmap_to_positions(const uint64_t *bits, size_t num_rows, size_t *out);
+
+// out[k] = data[p] for the k-th set position p, returns how many values were written
+size_t bitmap_fetch(const uint64_t *bits, size_t num_rows, const int *data, int *out);
+
+// sum of the set positions
+size_t bitmap_sum(const uint64_t *bits, size_t num_rows);
+
+// out = a & b (a | b) word by word, returns the number of bits set in out
+size_t bitmap_and(const uint64_t *a, const uint64_t *b, size_t num_rows, uint64_t *out);
+size_t bitmap_or(const uint64_t *a, const uint64_t *b, size_t num_rows, uint64_t *out);
+
+// lowest and highest set position, false when no bit is set
+bool bitmap_first(const uint64_t *bits, size_t num_rows, size_t *position);
+bool bitmap_last(const uint64_t *bits, size_t num_rows, size_t *position);
+
+#endif
@@ -29,6 +29,8 @@ int binary_search_value(int *values, int n, int value);
 
 int binary_search_index(int *values, int n, int value);
 
+size_t lower_bound_index(const int *values, size_t n, long value);
+
 BTNode *insert_btree_full(BTNode *root, int value, size_t position);
 
 BTNode *insert_non_full_btree(BTNode *root, int value, size_t position);
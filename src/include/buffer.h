@@ -0,0 +1,65 @@
+#ifndef BUFFER_H__
+#define BUFFER_H__
+
+#include <stddef.h>
+
+#include "morsel.h"
+
+// positions per pooled chunk, one morsel's worth (512 KB)
+#define CHUNK_SIZE MORSEL_SIZE
+// idle chunks kept for reuse, the rest are freed
+#define CHUNK_POOL_SIZE 32
+// smallest capacity a position buffer starts from
+#define MIN_BUFFER_SIZE 1024
+
+/*
+ * Scratch chunks of CHUNK_SIZE positions, recycled through a process-wide pool so that
+ * concurrent selects reuse the same few chunks instead of each faulting in new ones.
+ */
+size_t *acquire_chunk(void);
+
+void release_chunk(size_t *chunk);
+
+/*
+ * Growable select output. It starts from an estimate of the number of positions, grows
+ * by doubling when the estimate was short, and is trimmed to its length when finished,
+ * so a select never reserves room for every row of its input.
+ */
+typedef struct PositionBuffer
+{
+    size_t *data;
+    size_t length;
+    size_t capacity;
+} PositionBuffer;
+
+void position_buffer_init(PositionBuffer *buffer, size_t estimate);
+
+// makes room for n more positions and returns where they go; the caller adds to length
+size_t *position_buffer_reserve(PositionBuffer *buffer, size_t n);
+
+void position_buffer_append(PositionBuffer *buffer, const size_t *positions, size_t n);
+
+// shrinks the data to its length and returns it, the buffer is left empty
+size_t *position_buffer_finish(PositionBuffer *buffer);
+
+/*
+ * Outputs of a morsel-driven select: every morsel selects into a pooled chunk and keeps
+ * it. morsel_positions_gather then places the chunks in morsel order by a prefix sum
+ * over their counts, each copied straight to its offset and released on a worker.
+ */
+typedef struct MorselPositions
+{
+    size_t **slices;
+    size_t *counts;
+    size_t morsels;
+} MorselPositions;
+
+void morsel_positions_init(MorselPositions *outputs, size_t length);
+
+// takes over the chunk holding the count positions the morsel selected
+void morsel_positions_keep(MorselPositions *outputs, size_t morsel, size_t *chunk, size_t count);
+
+// appends the kept positions to buffer, releases their chunks and returns how many there were
+size_t morsel_positions_gather(MorselPositions *outputs, PositionBuffer *buffer);
+
+#endif
@@ -13,6 +13,14 @@ GeneralizedColumn* lookup_variables(char* db_name, char* table_name, char* colum
 
 void add_context(Result* result, ClientContext* client_context, char* name);
 
+void free_result(Result* result);
+
+void materialize_result(Result* result);
+
+void materialize_results(Result** results, size_t num_results);
+
+void evaluate_results(Result** results, size_t num_results);
+
 void allocate(ClientContext** context, size_t size);
 
 void deallocate(ClientContext* client_context);
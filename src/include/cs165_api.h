@@ -36,6 +36,11 @@ SOFTWARE.
 #define MAX_COLUMN_PATH 256
 #define NUM_BINS 64
 #define SELECTIVITY_THRES 0.6
+// a bitmap is smaller than a position array from 1/64 selectivity on, leave headroom for estimation error
+#define BITMAP_SELECTIVITY_THRES 0.05
+#define SELECTIVITY_SAMPLE_SIZE 1024
+// index selects keep their positions as ranges when there are at least this many positions per range
+#define RANGE_ENCODE_RATIO 16
 
 /**
  * EXTRA
@@ -74,6 +79,37 @@ typedef struct Histogram
     size_t counts[NUM_BINS];
 } Histogram;
 
+/*
+ * The memory mapping of a column file, shared by the column and the VIEW results
+ * pointing into it. A mapping is unmapped once the column has moved off it (capacity
+ * growth, shutdown) and its last view has been freed.
+ */
+typedef struct ColumnMapping
+{
+    int *data;
+    size_t size; // bytes
+    int refs;
+} ColumnMapping;
+
+// min and max of every ZONE_SIZE-row block of a column, used to prune scans
+typedef struct ZoneMap
+{
+    size_t num_zones;
+    size_t capacity;
+    int *min;
+    int *max;
+} ZoneMap;
+
+// running aggregates of a column, kept up to date by load and insert and persisted with the column
+typedef struct ColumnStats
+{
+    size_t count;
+    long sum;
+    int min;
+    int max;
+    size_t tombstones; // rows marked deleted; nothing deletes rows yet, so always 0
+} ColumnStats;
+
 typedef struct BTNode
 {
     int num_values;
@@ -83,14 +119,6 @@ typedef struct BTNode
     struct BTNode **children;
 } BTNode;
 
-typedef struct Partition
-{
-    size_t p_capacity;
-    size_t p_len;
-    int *values;
-    size_t *positions;
-} Partition;
-
 typedef struct Column
 {
     char name[MAX_SIZE_NAME];
@@ -104,6 +132,9 @@ typedef struct Column
     ColumnIndex *index;
     BTNode *btree_root;
     Histogram *histogram;
+    ZoneMap *zone_map;
+    ColumnMapping *mapping;
+    ColumnStats stats;
 } Column;
 
 /**
@@ -176,6 +207,26 @@ typedef enum ComparatorType
     GREATER_THAN_OR_EQUAL = 6
 } ComparatorType;
 
+/*
+ * How a result stores its payload:
+ * MATERIALIZED: num_tuples values of data_type
+ * BITMAP: positions as one bit per row of the source column, (num_rows + 63) / 64 words;
+ *         num_tuples is the number of set bits
+ * DEFERRED: payload is the PipelineNode computing the result, evaluated on first use;
+ *           num_tuples is unknown until then
+ * RANGES: positions as num_ranges ascending, disjoint PositionRanges; num_tuples is
+ *         the total length of the ranges
+ * VIEW: num_tuples INT values borrowed from a column, payload points into mapping
+ */
+typedef enum ResultFormat
+{
+    MATERIALIZED,
+    BITMAP,
+    DEFERRED,
+    RANGES,
+    VIEW,
+} ResultFormat;
+
 /*
  * Declares the type of a result column, 
  which includes the number of tuples in the result, the data type of the result, and a pointer to the result data
@@ -185,6 +236,10 @@ typedef struct Result
     size_t num_tuples;
     DataType data_type;
     void *payload;
+    ResultFormat format;
+    size_t num_rows;   // BITMAP only: rows of the source column covered by the bitmap
+    size_t num_ranges; // RANGES only: number of PositionRanges in payload
+    ColumnMapping *mapping; // VIEW only: the column mapping payload points into
 } Result;
 
 /*
@@ -234,7 +289,9 @@ typedef struct ClientContext
     int chandle_slots;   // hashtable->size
     bool batch_mode;     // true: in batch_mode
     // TODO: handle multiple clients
-    // int num_batch_queries;
+    struct DbOperator **batch_queries; // selects and fetches queued until batch_execute
+    size_t num_batch_queries;
+    size_t batch_capacity;
 } ClientContext;
 
 /**
@@ -267,6 +324,10 @@ typedef enum OperatorType
     BATCH_START,
     BATCH_END,
     JOIN,
+    FUSED_AGGREGATE,
+    MULTI_SELECT,
+    POSITION_SET,
+    GROUP_BY,
 } OperatorType;
 
 typedef enum CreateType
@@ -285,6 +346,10 @@ typedef enum AggregateType
     SUB,
     MIN,
     MAX,
+    COUNT,
+    MUL,
+    DIV,
+    NEG,
 } AggregateType;
 
 typedef enum SelectType
@@ -348,11 +413,18 @@ typedef struct SelectOperator
     int high;
 } SelectOperator;
 
+#define MAX_FETCH_COLUMNS 8
+
+/*
+ * f=fetch(db.tbl.col,positions), or f1,f2,...=fetch(db.tbl.(c1,c2,...),positions):
+ * the values of each column at the positions, gathered in one pass over them
+ */
 typedef struct FetchOperator
 {
-    Column *column;
-    char intermediate[MAX_SIZE_NAME];
-    char *positions;
+    size_t num_columns;
+    Column *columns[MAX_FETCH_COLUMNS];
+    char intermediates[MAX_FETCH_COLUMNS][MAX_SIZE_NAME];
+    char positions[MAX_SIZE_NAME];
 } FetchOperator;
 
 typedef struct PrintOperator
@@ -368,8 +440,70 @@ typedef struct AggregateOperator
     int variable_number;
     GeneralizedColumn *gc1;
     GeneralizedColumn *gc2;
+    Result *constant; // a literal operand, owned by the operator
 } AggregateOperator;
 
+/*
+ * aggregate(fetch(fetch_column, select(select_column, low, high))) evaluated in one
+ * pass, without materializing the positions or the fetched values;
+ * count(select(select_column, low, high)) has fetch_column == select_column
+ */
+typedef struct FusedAggregateOperator
+{
+    AggregateType aggregate_type;
+    char intermediate[MAX_SIZE_NAME];
+    Column *select_column;
+    Column *fetch_column;
+    size_t column_length;
+    int low;
+    int high;
+} FusedAggregateOperator;
+
+#define MAX_SELECT_PREDICATES 8
+
+// low <= value <= high on one column
+typedef struct ColumnPredicate
+{
+    Column *column;
+    int low;
+    int high;
+} ColumnPredicate;
+
+/*
+ * select(and(db.tbl.c1,low,high),(db.tbl.c2,low,high),...), or or(...) for disjunctive:
+ * positions of the rows satisfying all (any) of the predicates, over columns of one table
+ */
+typedef struct MultiSelectOperator
+{
+    char intermediate[MAX_SIZE_NAME];
+    bool disjunctive;
+    size_t column_length;
+    size_t num_predicates;
+    ColumnPredicate predicates[MAX_SELECT_PREDICATES];
+} MultiSelectOperator;
+
+// and(s1,s2) / or(s1,s2): intersection / union of two position results
+typedef struct PositionSetOperator
+{
+    char intermediate[MAX_SIZE_NAME];
+    char left[MAX_SIZE_NAME];
+    char right[MAX_SIZE_NAME];
+    bool disjunctive;
+} PositionSetOperator;
+
+/*
+ * k,a=group_by(keys,values,agg): the distinct keys in ascending order into k and the
+ * sum/avg/min/max of the values of every key into a
+ */
+typedef struct GroupByOperator
+{
+    char keys_name[MAX_SIZE_NAME];
+    char aggregates_name[MAX_SIZE_NAME];
+    AggregateType aggregate_type;
+    GeneralizedColumn *keys;
+    GeneralizedColumn *values;
+} GroupByOperator;
+
 typedef struct JoinOperator
 {
     char l_name[MAX_SIZE_NAME];
@@ -393,6 +527,10 @@ typedef union OperatorFields
     PrintOperator print_operator;
     AggregateOperator aggregate_operator;
     JoinOperator join_operator;
+    FusedAggregateOperator fused_aggregate_operator;
+    MultiSelectOperator multi_select_operator;
+    PositionSetOperator position_set_operator;
+    GroupByOperator group_by_operator;
 } OperatorFields;
 
 /*
@@ -427,12 +565,28 @@ Column *create_column(Table *table, char *name, Status *ret_status);
 
 SelectType optimize(Column *column, int low, int high);
 
+double estimate_selectivity(Column *column, int low, int high);
+
+ResultFormat choose_position_format(Column *column, int low, int high);
+
 void create_index(Column *column, bool sorted, bool btree, bool clustered, Status *ret_status);
 
 void build_primary_index(Table *table, size_t primary_column_index);
 
 void build_secondary_index(Column *primary_column, bool btree);
 
+void build_zone_map(Column *column);
+
+void update_zone_map(Column *column, size_t position);
+
+void free_zone_map(Column *column);
+
+void reset_column_stats(Column *column);
+
+void build_column_stats(Column *column);
+
+void update_column_stats(Column *column, int value);
+
 long binary_search(int* array, long l, long r, int x);
 
 Status shutdown_server();
@@ -0,0 +1,72 @@
+#ifndef FETCH_H__
+#define FETCH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "morsel.h"
+
+// fetches shorter than this run on the calling thread
+#define PARALLEL_FETCH_THRESHOLD (4 * MORSEL_SIZE)
+
+// a random gather prefetches the row this many positions ahead
+#define FETCH_PREFETCH_DISTANCE 32
+
+// the kernel for a morsel is picked from the pattern of its first FETCH_SAMPLE positions
+#define FETCH_SAMPLE 256
+
+// ascending positions averaging runs of at least this many consecutive rows are copied run by run
+#define MIN_MEMCPY_RUN 8
+
+// ascending positions spanning fewer rows per position than one cache line holds need no prefetch
+#define CACHE_LINE_INTS 16
+
+/*
+ * Gather kernels: out[i] = data[positions[i]] for i in [start, end). With
+ * prefetch set, the row FETCH_PREFETCH_DISTANCE positions ahead is prefetched
+ * so the cache misses of random positions overlap. The AVX2 kernel gathers
+ * four rows per _mm256_i64gather_epi32.
+ */
+typedef void (*fetch_gather_fn)(const int *data, const size_t *positions, size_t start, size_t end, bool prefetch, int *out);
+
+void fetch_gather_scalar(const int *data, const size_t *positions, size_t start, size_t end, bool prefetch, int *out);
+
+void fetch_gather_avx2(const int *data, const size_t *positions, size_t start, size_t end, bool prefetch, int *out);
+
+// dispatch to the widest kernel supported by the cpu
+void fetch_gather(const int *data, const size_t *positions, size_t start, size_t end, bool prefetch, int *out);
+
+// copies every run of consecutive positions in [start, end), long runs with one memcpy
+void fetch_runs(const int *data, const size_t *positions, size_t start, size_t end, int *out);
+
+/*
+ * out[i] = data[positions[i]] for i in [start, end), through the kernel that
+ * suits the order, runs and span of the first FETCH_SAMPLE positions.
+ */
+void fetch_positions(const int *data, const size_t *positions, size_t start, size_t end, int *out);
+
+/*
+ * outs[c][i] = columns[c][positions[i]] for every column, interleaved: the
+ * rows of all columns at one position are loaded, and the rows
+ * FETCH_PREFETCH_DISTANCE positions ahead prefetched, together, so their
+ * misses overlap and the positions are read once.
+ */
+void fetch_gather_columns(const int *const *columns, size_t num_columns, const size_t *positions, size_t start, size_t end, int *const *outs);
+
+/*
+ * fetch_positions over several columns sharing the positions: random and
+ * sparse positions are gathered interleaved, runs and dense positions are
+ * fetched column by column.
+ */
+void fetch_positions_columns(const int *const *columns, size_t num_columns, const size_t *positions, size_t start, size_t end, int *const *outs);
+
+/*
+ * outs[c][i] = columns[c][positions[i]] over [0, length), every column in one
+ * pass over the positions. Every morsel samples its own positions: ascending
+ * runs of consecutive rows are copied run by run, other ascending positions
+ * are gathered, and random ones are gathered with software prefetching.
+ * Fetches of PARALLEL_FETCH_THRESHOLD positions or more are split into morsels.
+ */
+void parallel_fetch_columns(const int *const *columns, size_t num_columns, const size_t *positions, size_t length, int *const *outs);
+
+#endif
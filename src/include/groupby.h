@@ -0,0 +1,50 @@
+#ifndef GROUPBY_H__
+#define GROUPBY_H__
+
+#include <stddef.h>
+
+#include "cs165_api.h"
+
+// rows are radix-partitioned on 6 hash bits when the groups do not fit in L2
+#define GROUP_PARTITION_BITS 6
+#define GROUP_PARTITIONS (1 << GROUP_PARTITION_BITS)
+#define L2_CACHE_SIZE (256 * 1024)
+
+// integer values are aggregated exactly in i, float values in f
+typedef union GroupValue
+{
+    long i;
+    double f;
+} GroupValue;
+
+// one group of an open-addressing table: a slot with count 0 is empty
+typedef struct GroupEntry
+{
+    long key;
+    size_t count;
+    GroupValue sum;
+    GroupValue min;
+    GroupValue max;
+} GroupEntry;
+
+// groups a table can hold at half load while staying in L2
+#define GROUP_CACHE_GROUPS (L2_CACHE_SIZE / (2 * sizeof(GroupEntry)))
+
+// runs shorter than this are aggregated row by row rather than through the reduction kernels
+#define RUN_KERNEL_MIN 64
+
+/*
+ * Groups values[i] by keys[i] over [0, length). keys are INT or LONG, values
+ * INT, LONG, FLOAT or DOUBLE. *groups receives one entry per distinct key in
+ * ascending key order; returns the number of groups.
+ *
+ * Ascending keys (sorted is set by the caller for a clustered column, other
+ * keys are checked) form one run per group: morsels aggregate the runs that
+ * start in them, without a table. Otherwise every morsel aggregates into its
+ * own table and the tables are merged in morsel order; when a sample shows
+ * more than GROUP_CACHE_GROUPS groups, rows are first partitioned by key hash
+ * and every partition is aggregated on its own.
+ */
+size_t group_by(const void *keys, DataType key_type, const void *values, DataType value_type, size_t length, bool sorted, GroupEntry **groups);
+
+#endif
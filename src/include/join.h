@@ -0,0 +1,150 @@
+#ifndef JOIN_H__
+#define JOIN_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "buffer.h"
+
+// equi-width buckets over the value range both join inputs share
+#define JOIN_HISTOGRAM_BUCKETS 1024
+
+/*
+ * Value histograms of the two sides of an equi-join over [low, high], the
+ * intersection of their value ranges. Values outside it cannot match and are
+ * not counted. The histogram sizes the join's output buffers and gives the
+ * exact sizes of range partitions made of whole buckets.
+ */
+typedef struct JoinHistogram
+{
+    bool empty; // the value ranges do not overlap, the join is empty
+    int low;
+    int high;
+    long width; // values per bucket
+    size_t left[JOIN_HISTOGRAM_BUCKETS];
+    size_t right[JOIN_HISTOGRAM_BUCKETS];
+} JoinHistogram;
+
+void join_histogram(const int *left, size_t left_length, const int *right, size_t right_length, JoinHistogram *histogram);
+
+// bucket of value, or JOIN_HISTOGRAM_BUCKETS when it lies outside [low, high]
+static inline size_t join_bucket(const JoinHistogram *histogram, int value)
+{
+    if (histogram->empty || value < histogram->low || value > histogram->high)
+        return JOIN_HISTOGRAM_BUCKETS;
+    return (size_t)(((long)value - histogram->low) / histogram->width);
+}
+
+/*
+ * Estimated number of matching pairs in buckets [first, end). Each bucket
+ * holds about min(width, larger count) distinct values, every value matching
+ * left * right / distinct pairs: a key joined with a foreign key gives the
+ * smaller count, a few repeated values their product over the distinct count.
+ */
+size_t estimate_join_size(const JoinHistogram *histogram, size_t first, size_t end);
+
+// one distinct key of a JoinTable and the run of its positions
+typedef struct JoinSlot
+{
+    int key;
+    unsigned int count; // 0 marks an empty slot
+    size_t offset;
+} JoinSlot;
+
+// slots per build row: the table is at most half full
+#define JOIN_TABLE_LOAD 2
+
+/*
+ * Flat hash table over the build side of an equi-join. Slots are probed
+ * linearly from a multiplicative hash of the key, and the positions of all
+ * rows with one key are stored as a contiguous run, so building or probing a
+ * key touches one or two cache lines of slots and a probe hands back every
+ * match at once. The table is allocated once for the largest build side and
+ * rebuilt for each partition.
+ */
+typedef struct JoinTable
+{
+    JoinSlot *slots;
+    size_t *positions;
+    size_t capacity; // slots allocated
+    size_t mask;     // slots in use - 1
+    unsigned int bits;
+} JoinTable;
+
+// the matching positions of one probe key: positions[0, count)
+typedef struct JoinMatches
+{
+    const size_t *positions;
+    size_t count;
+} JoinMatches;
+
+void join_table_init(JoinTable *table, size_t max_rows);
+
+// rebuilds the table over keys and positions [0, length), length at most the table's max_rows
+void join_table_build(JoinTable *table, const int *keys, const size_t *positions, size_t length);
+
+void join_table_free(JoinTable *table);
+
+// fibonacci hashing: the top bits of the key times 2^64 / phi
+static inline size_t join_table_slot(const JoinTable *table, int key)
+{
+    return (size_t)(((unsigned long long)(unsigned int)key * 0x9E3779B97F4A7C15ull) >> (64 - table->bits));
+}
+
+static inline JoinMatches join_table_probe(const JoinTable *table, int key)
+{
+    JoinMatches matches = {NULL, 0};
+    for (size_t i = join_table_slot(table, key); table->slots[i].count != 0; i = (i + 1) & table->mask)
+    {
+        if (table->slots[i].key == key)
+        {
+            matches.positions = table->positions + table->slots[i].offset;
+            matches.count = table->slots[i].count;
+            break;
+        }
+    }
+    return matches;
+}
+
+/*
+ * Builds table over the build rows and probes it with every probe row,
+ * appending the build and probe position of each matching pair to build_out
+ * and probe_out.
+ */
+void hash_join(JoinTable *table, const int *build_keys, const size_t *build_positions, size_t build_length,
+               const int *probe_keys, const size_t *probe_positions, size_t probe_length,
+               PositionBuffer *build_out, PositionBuffer *probe_out);
+
+// radix bits per partitioning pass: 128 output streams stay within the TLB and the L1 cache
+#define RADIX_BITS_PER_PASS 7
+
+#define RADIX_MAX_PASSES 2
+
+// the build side of a final partition and its hash table are sized to fit the L2 cache
+#define RADIX_PARTITION_BYTES (256 * 1024)
+
+// bytes per build row in a final partition: its key and position, and its share of the JoinTable
+#define RADIX_BUILD_ROW_BYTES (sizeof(int) + 2 * sizeof(size_t) + JOIN_TABLE_LOAD * sizeof(JoinSlot))
+
+
+/*
+ * Radix hash join of left and right, emitting the positions of every
+ * matching pair into left_out and right_out, which it initializes. Only
+ * values inside the histogram's shared range take part.
+ *
+ * The keys are hashed and partitioned on RADIX_BITS_PER_PASS bits of the hash
+ * per pass, in up to RADIX_MAX_PASSES passes, until the build side of a
+ * partition fits RADIX_PARTITION_BYTES. The first pass runs over morsels of
+ * both inputs on all cores: every morsel counts its rows per partition, a
+ * prefix sum over the counts gives each morsel its own write offsets, and the
+ * morsels scatter into one preallocated buffer per input. Each first-pass
+ * partition is then partitioned again, built and probed by one worker into its
+ * own output buffers, without any lock. A prefix sum over their lengths gives
+ * every partition its offset in the result, and they are copied there in
+ * parallel.
+ */
+void radix_join(const int *left, const size_t *left_positions, size_t left_length,
+                const int *right, const size_t *right_positions, size_t right_length,
+                const JoinHistogram *histogram, PositionBuffer *left_out, PositionBuffer *right_out);
+
+#endif
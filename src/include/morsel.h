@@ -0,0 +1,25 @@
+#ifndef MORSEL_H__
+#define MORSEL_H__
+
+#include <stddef.h>
+
+// 64K rows: large enough to amortize scheduling, small enough to balance load
+#define MORSEL_SIZE 65536
+
+/*
+ * morsel_fn is called once per morsel with the morsel number and the row
+ * range [start, end) it covers.
+ */
+typedef void (*morsel_fn)(void *arg, size_t morsel, size_t start, size_t end);
+
+// number of morsels run_morsels splits length rows into
+size_t num_morsels(size_t length, size_t morsel_size);
+
+/*
+ * Splits [0, length) into morsels of morsel_size rows and runs fn on each of
+ * them. Worker threads and the calling thread claim morsels from a shared
+ * counter until none are left; the call returns once every morsel finished.
+ */
+void run_morsels(size_t length, size_t morsel_size, morsel_fn fn, void *arg);
+
+#endif
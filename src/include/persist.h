@@ -2,6 +2,7 @@
 #include "common.h"
 #include "utils.h"
 #include "btree.h"
+#include "scan.h"
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -16,6 +17,12 @@ int map_column(Table* table, Column* column);
 
 int syncing_column (Column* column, Table* table);
 
+// the column's current mapping with one more reference, for a view into the column
+ColumnMapping* acquire_mapping(Column* column);
+
+// drops a reference, the last one unmaps the mapping; returns -1 when munmap fails
+int release_mapping(ColumnMapping* mapping);
+
 // void map_context(char* intermediate, int context_capacity, void* data);
 
 int persist_database();
@@ -28,4 +35,8 @@ int persist_index(char* table_name, char* column_name, Column* current_column);
 
 int load_index(char* table_name, char* column_name, Column* current_column);
 
+int persist_zone_map(char* table_name, char* column_name, Column* current_column);
+
+int load_zone_map(char* table_name, char* column_name, Column* current_column);
+
 int free_database();
\ No newline at end of file
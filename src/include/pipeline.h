@@ -0,0 +1,64 @@
+#ifndef PIPELINE_H__
+#define PIPELINE_H__
+
+#include "cs165_api.h"
+
+// 1024 tuples: the vectors of a whole chain of operators stay in L1/L2
+#define VECTOR_SIZE 1024
+
+/*
+ * Deferred operators. A named intermediate produced by a select, fetch, add/sub or
+ * aggregate over other deferred intermediates is only recorded as a node; the chain
+ * of nodes is evaluated when a statement needs the values, VECTOR_SIZE rows of the
+ * driving scan at a time, without materializing the intermediates in between.
+ */
+typedef enum PipelineNodeType
+{
+    SCAN_NODE,      // positions of column rows in [low, high]
+    FILTER_NODE,    // positions of inputs[0] whose value in inputs[1] lies in [low, high]
+    FETCH_NODE,     // column values at the positions of inputs[0]
+    ARITH_NODE,     // inputs[0] + or - inputs[1]
+    AGGREGATE_NODE, // sum/avg/min/max of inputs[0]
+} PipelineNodeType;
+
+typedef struct PipelineNode
+{
+    PipelineNodeType type;
+    int refs;
+    DataType data_type;           // type of the vector the node produces
+    struct PipelineNode *source;  // the scan driving the pipeline
+    struct PipelineNode *domain;  // positions node the vector is aligned with, NULL for aggregates
+    struct PipelineNode *inputs[2];
+    Column *column;
+    size_t column_length;
+    int low;
+    int high;
+    AggregateType aggregate_type;
+} PipelineNode;
+
+PipelineNode *pipeline_scan(Column *column, size_t column_length, int low, int high);
+
+// NULL when values is not aligned with positions
+PipelineNode *pipeline_filter(PipelineNode *positions, PipelineNode *values, int low, int high);
+
+// NULL when positions is not a positions node
+PipelineNode *pipeline_fetch(Column *column, PipelineNode *positions);
+
+// NULL when the operands are not aligned
+PipelineNode *pipeline_arith(AggregateType aggregate_type, PipelineNode *left, PipelineNode *right);
+
+// NULL when input does not produce a vector
+PipelineNode *pipeline_aggregate(AggregateType aggregate_type, PipelineNode *input);
+
+// a DEFERRED Result owning node
+Result *pipeline_result(PipelineNode *node);
+
+void pipeline_release(PipelineNode *node);
+
+/*
+ * Evaluates targets, which must share one source, in a single pass over it.
+ * results[i] receives a new materialized Result for targets[i].
+ */
+void pipeline_run(PipelineNode **targets, size_t num_targets, Result **results);
+
+#endif
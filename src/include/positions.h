@@ -0,0 +1,37 @@
+#ifndef POSITIONS_H__
+#define POSITIONS_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// intersections gallop through the larger list once it is this many times the smaller one
+#define GALLOP_RATIO 32
+
+/*
+ * Set operations over ascending position lists without duplicates. out must have room
+ * for the smaller input (intersection) or both inputs (union); the number of
+ * positions written is returned, in ascending order.
+ */
+
+// merge-based, 4 x 4 positions compared per step with AVX2
+size_t intersect_positions_merge(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out);
+
+// looks every position of a up in b by exponential search, for na much smaller than nb
+size_t intersect_positions_gallop(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out);
+
+// picks galloping or merging from the input sizes
+size_t intersect_positions(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out);
+
+size_t union_positions(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out);
+
+/*
+ * Morsel-driven versions: a is split into morsels, the matching slice of b is found by
+ * binary search, and the per-morsel outputs are concatenated in order.
+ */
+size_t parallel_intersect_positions(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out);
+size_t parallel_union_positions(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out);
+
+// true when positions are strictly ascending
+bool positions_sorted(const size_t *positions, size_t num_positions);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef RANGES_H__
+#define RANGES_H__
+
+#include <stddef.h>
+
+/*
+ * Range-encoded positions: the positions [start, end) of each range, ranges ascending
+ * and disjoint. An index select over a clustered column is a single range.
+ */
+typedef struct PositionRange
+{
+    size_t start;
+    size_t end;
+} PositionRange;
+
+// writes the positions of the ranges to out in ascending order, returns how many were written
+size_t ranges_to_positions(const PositionRange *ranges, size_t num_ranges, size_t *out);
+
+// copies the column slice of every range to out, returns how many values were written
+size_t ranges_fetch(const PositionRange *ranges, size_t num_ranges, const int *data, int *out);
+
+// sum of the positions covered by the ranges
+size_t ranges_sum(const PositionRange *ranges, size_t num_ranges);
+
+/*
+ * Encodes ascending positions as ranges when there are at most max_ranges runs of
+ * consecutive positions. Returns the number of ranges written to *ranges (allocated
+ * here), or 0 with *ranges untouched when the positions do not fit.
+ */
+size_t positions_to_ranges(const size_t *positions, size_t num_positions, size_t max_ranges, PositionRange **ranges);
+
+#endif
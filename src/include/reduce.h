@@ -0,0 +1,66 @@
+#ifndef REDUCE_H__
+#define REDUCE_H__
+
+#include <stddef.h>
+
+#include "morsel.h"
+
+// reductions shorter than this run on the calling thread
+#define PARALLEL_REDUCE_THRESHOLD (4 * MORSEL_SIZE)
+
+/*
+ * Sum kernels over data[start, end). Integers are summed exactly in 64 bits,
+ * floats in double. The scalar kernels keep four independent accumulators,
+ * the AVX2 kernels four vector accumulators.
+ */
+long sum_int_scalar(const int *data, size_t start, size_t end);
+long sum_long_scalar(const long *data, size_t start, size_t end);
+double sum_float_scalar(const float *data, size_t start, size_t end);
+double sum_double_scalar(const double *data, size_t start, size_t end);
+
+long sum_int_avx2(const int *data, size_t start, size_t end);
+long sum_long_avx2(const long *data, size_t start, size_t end);
+double sum_float_avx2(const float *data, size_t start, size_t end);
+double sum_double_avx2(const double *data, size_t start, size_t end);
+
+// dispatch to the widest kernel supported by the cpu
+long sum_int(const int *data, size_t start, size_t end);
+long sum_long(const long *data, size_t start, size_t end);
+double sum_float(const float *data, size_t start, size_t end);
+double sum_double(const double *data, size_t start, size_t end);
+
+/*
+ * Min and max kernels over data[start, end), computed in one pass and folded
+ * into *min and *max, which the caller initializes.
+ */
+void minmax_int_scalar(const int *data, size_t start, size_t end, int *min, int *max);
+void minmax_long_scalar(const long *data, size_t start, size_t end, long *min, long *max);
+void minmax_float_scalar(const float *data, size_t start, size_t end, float *min, float *max);
+void minmax_double_scalar(const double *data, size_t start, size_t end, double *min, double *max);
+
+void minmax_int_avx2(const int *data, size_t start, size_t end, int *min, int *max);
+void minmax_long_avx2(const long *data, size_t start, size_t end, long *min, long *max);
+void minmax_float_avx2(const float *data, size_t start, size_t end, float *min, float *max);
+void minmax_double_avx2(const double *data, size_t start, size_t end, double *min, double *max);
+
+void minmax_int(const int *data, size_t start, size_t end, int *min, int *max);
+void minmax_long(const long *data, size_t start, size_t end, long *min, long *max);
+void minmax_float(const float *data, size_t start, size_t end, float *min, float *max);
+void minmax_double(const double *data, size_t start, size_t end, double *min, double *max);
+
+/*
+ * Morsel-driven versions over [0, length): every morsel is reduced on a worker
+ * thread and the partials are combined in morsel order, so float sums do not
+ * depend on scheduling.
+ */
+long parallel_sum_int(const int *data, size_t length);
+long parallel_sum_long(const long *data, size_t length);
+double parallel_sum_float(const float *data, size_t length);
+double parallel_sum_double(const double *data, size_t length);
+
+void parallel_minmax_int(const int *data, size_t length, int *min, int *max);
+void parallel_minmax_long(const long *data, size_t length, long *min, long *max);
+void parallel_minmax_float(const float *data, size_t length, float *min, float *max);
+void parallel_minmax_double(const double *data, size_t length, double *min, double *max);
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef SCAN_H__
+#define SCAN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "buffer.h"
+
+// rows per zone-map block: divides MORSEL_SIZE and is a multiple of the 64-bit bitmap word
+#define ZONE_SIZE 4096
+
+/*
+ * Range-predicate scan kernels.
+ * Every kernel writes the positions i in [start, end) with
+ * low <= data[i] <= high into out, in ascending order, and returns the
+ * number of positions written. out must have room for (end - start) entries.
+ */
+typedef size_t (*select_range_fn)(const int *data, size_t start, size_t end, int low, int high, size_t *out);
+
+// branch-free scalar kernel, the fallback when no SIMD extension is available
+size_t select_range_scalar(const int *data, size_t start, size_t end, int low, int high, size_t *out);
+
+// SSE4.1 kernel, 4 values per compare
+size_t select_range_sse4(const int *data, size_t start, size_t end, int low, int high, size_t *out);
+
+// AVX2 kernel, 8 values per compare
+size_t select_range_avx2(const int *data, size_t start, size_t end, int low, int high, size_t *out);
+
+// dispatches to the widest kernel supported by the cpu (resolved once via cpuid)
+size_t select_range(const int *data, size_t start, size_t end, int low, int high, size_t *out);
+
+/*
+ * Zone-pruned select_range: zone_min[z] and zone_max[z] bound the values of rows
+ * [z * ZONE_SIZE, (z + 1) * ZONE_SIZE). Zones outside [low, high] are skipped and
+ * zones inside it are taken without comparisons. start must be a multiple of
+ * ZONE_SIZE; NULL zone arrays fall back to select_range.
+ */
+size_t select_range_zoned(const int *data, size_t start, size_t end, const int *zone_min, const int *zone_max, int low, int high, size_t *out);
+
+/*
+ * Morsel-driven version of select_range_zoned over [0, length): morsels are scanned
+ * on worker threads and appended to out in position order. Returns the number appended.
+ */
+size_t parallel_select_range(const int *data, size_t length, const int *zone_min, const int *zone_max, int low, int high, PositionBuffer *out);
+
+/*
+ * Bitmap-emitting kernels: bit i % 64 of bits[i / 64] is set for every i in
+ * [start, end) with low <= data[i] <= high. start must be a multiple of 64;
+ * the words covering [start, end) are overwritten, bits past end are cleared.
+ * Returns the number of bits set.
+ */
+typedef size_t (*select_bitmap_fn)(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits);
+
+size_t select_bitmap_scalar(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits);
+
+size_t select_bitmap_sse4(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits);
+
+size_t select_bitmap_avx2(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits);
+
+size_t select_bitmap(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits);
+
+// zone-pruned select_bitmap, same contract as select_range_zoned
+size_t select_bitmap_zoned(const int *data, size_t start, size_t end, const int *zone_min, const int *zone_max, int low, int high, uint64_t *bits);
+
+// morsel-driven select_bitmap_zoned over [0, length), bits must hold bitmap_words(length) words
+size_t parallel_select_bitmap(const int *data, size_t length, const int *zone_min, const int *zone_max, int low, int high, uint64_t *bits);
+
+/*
+ * Position-filter kernels for TWO_COLUMN selects: write positions[i] for every i in
+ * [start, end) with low <= values[i] <= high into out, in order, and return the
+ * number written. out must have room for (end - start) entries. One family per value
+ * type; the vector kernels mask the last partial vector instead of a scalar tail.
+ */
+typedef size_t (*filter_positions_int_fn)(const size_t *positions, const int *values, size_t start, size_t end, int low, int high, size_t *out);
+typedef size_t (*filter_positions_long_fn)(const size_t *positions, const long *values, size_t start, size_t end, int low, int high, size_t *out);
+typedef size_t (*filter_positions_float_fn)(const size_t *positions, const float *values, size_t start, size_t end, int low, int high, size_t *out);
+typedef size_t (*filter_positions_double_fn)(const size_t *positions, const double *values, size_t start, size_t end, int low, int high, size_t *out);
+
+size_t filter_positions_int_scalar(const size_t *positions, const int *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_long_scalar(const size_t *positions, const long *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_float_scalar(const size_t *positions, const float *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_double_scalar(const size_t *positions, const double *values, size_t start, size_t end, int low, int high, size_t *out);
+
+size_t filter_positions_int_avx2(const size_t *positions, const int *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_long_avx2(const size_t *positions, const long *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_float_avx2(const size_t *positions, const float *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_double_avx2(const size_t *positions, const double *values, size_t start, size_t end, int low, int high, size_t *out);
+
+// dispatch to the widest kernel supported by the cpu
+size_t filter_positions_int(const size_t *positions, const int *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_long(const size_t *positions, const long *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_float(const size_t *positions, const float *values, size_t start, size_t end, int low, int high, size_t *out);
+size_t filter_positions_double(const size_t *positions, const double *values, size_t start, size_t end, int low, int high, size_t *out);
+
+// morsel-driven versions over [0, length), appending to out
+size_t parallel_filter_positions_int(const size_t *positions, const int *values, size_t length, int low, int high, PositionBuffer *out);
+size_t parallel_filter_positions_long(const size_t *positions, const long *values, size_t length, int low, int high, PositionBuffer *out);
+size_t parallel_filter_positions_float(const size_t *positions, const float *values, size_t length, int low, int high, PositionBuffer *out);
+size_t parallel_filter_positions_double(const size_t *positions, const double *values, size_t length, int low, int high, PositionBuffer *out);
+
+#endif
@@ -0,0 +1,399 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "join.h"
+#include "reduce.h"
+
+void join_histogram(const int *left, size_t left_length, const int *right, size_t right_length, JoinHistogram *histogram)
+{
+    memset(histogram->left, 0, sizeof(histogram->left));
+    memset(histogram->right, 0, sizeof(histogram->right));
+    histogram->empty = true;
+    if (left_length == 0 || right_length == 0)
+        return;
+    int left_min, left_max, right_min, right_max;
+    parallel_minmax_int(left, left_length, &left_min, &left_max);
+    parallel_minmax_int(right, right_length, &right_min, &right_max);
+    histogram->low = left_min > right_min ? left_min : right_min;
+    histogram->high = left_max < right_max ? left_max : right_max;
+    if (histogram->low > histogram->high)
+        return;
+    histogram->empty = false;
+    long range = (long)histogram->high - histogram->low + 1;
+    histogram->width = (range + JOIN_HISTOGRAM_BUCKETS - 1) / JOIN_HISTOGRAM_BUCKETS;
+    for (size_t i = 0; i < left_length; i++)
+    {
+        size_t bucket = join_bucket(histogram, left[i]);
+        if (bucket < JOIN_HISTOGRAM_BUCKETS)
+            histogram->left[bucket]++;
+    }
+    for (size_t i = 0; i < right_length; i++)
+    {
+        size_t bucket = join_bucket(histogram, right[i]);
+        if (bucket < JOIN_HISTOGRAM_BUCKETS)
+            histogram->right[bucket]++;
+    }
+}
+
+size_t estimate_join_size(const JoinHistogram *histogram, size_t first, size_t end)
+{
+    if (histogram->empty)
+        return 0;
+    double estimate = 0;
+    for (size_t b = first; b < end; b++)
+    {
+        size_t larger = histogram->left[b] > histogram->right[b] ? histogram->left[b] : histogram->right[b];
+        if (larger == 0)
+            continue;
+        double distinct = (double)larger < (double)histogram->width ? (double)larger : (double)histogram->width;
+        estimate += (double)histogram->left[b] * (double)histogram->right[b] / distinct;
+    }
+    return (size_t)estimate;
+}
+
+void join_table_init(JoinTable *table, size_t max_rows)
+{
+    table->capacity = 2;
+    while (table->capacity < JOIN_TABLE_LOAD * max_rows)
+        table->capacity <<= 1;
+    table->slots = malloc(table->capacity * sizeof(JoinSlot));
+    table->positions = malloc((max_rows > 0 ? max_rows : 1) * sizeof(size_t));
+    table->mask = table->capacity - 1;
+    table->bits = 1;
+}
+
+static JoinSlot *join_table_insert(JoinTable *table, int key)
+{
+    size_t i = join_table_slot(table, key);
+    while (table->slots[i].count != 0 && table->slots[i].key != key)
+        i = (i + 1) & table->mask;
+    table->slots[i].key = key;
+    return &table->slots[i];
+}
+
+void join_table_build(JoinTable *table, const int *keys, const size_t *positions, size_t length)
+{
+    // only as many slots as this build side needs are cleared and probed
+    table->bits = 1;
+    while (((size_t)1 << table->bits) < JOIN_TABLE_LOAD * length)
+        table->bits++;
+    table->mask = ((size_t)1 << table->bits) - 1;
+    memset(table->slots, 0, (table->mask + 1) * sizeof(JoinSlot));
+    for (size_t i = 0; i < length; i++)
+        join_table_insert(table, keys[i])->count++;
+    // every key's run ends where the next one starts; the scatter below fills it back to front
+    size_t offset = 0;
+    for (size_t s = 0; s <= table->mask; s++)
+    {
+        offset += table->slots[s].count;
+        table->slots[s].offset = offset;
+    }
+    for (size_t i = length; i-- > 0;)
+    {
+        JoinSlot *slot = join_table_insert(table, keys[i]);
+        table->positions[--slot->offset] = positions[i];
+    }
+}
+
+void join_table_free(JoinTable *table)
+{
+    free(table->slots);
+    free(table->positions);
+}
+
+void hash_join(JoinTable *table, const int *build_keys, const size_t *build_positions, size_t build_length,
+               const int *probe_keys, const size_t *probe_positions, size_t probe_length,
+               PositionBuffer *build_out, PositionBuffer *probe_out)
+{
+    join_table_build(table, build_keys, build_positions, build_length);
+    for (size_t j = 0; j < probe_length; j++)
+    {
+        JoinMatches matches = join_table_probe(table, probe_keys[j]);
+        if (matches.count == 0)
+            continue;
+        position_buffer_append(build_out, matches.positions, matches.count);
+        size_t *out = position_buffer_reserve(probe_out, matches.count);
+        for (size_t k = 0; k < matches.count; k++)
+            out[k] = probe_positions[j];
+        probe_out->length += matches.count;
+    }
+}
+
+// murmur3 finalizer: every bit of the key reaches every radix digit, so skewed or clustered keys still spread
+static inline unsigned int radix_hash(int key)
+{
+    unsigned int h = (unsigned int)key;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline size_t radix_digit(int key, unsigned int shift, unsigned int bits)
+{
+    return (radix_hash(key) >> shift) & ((1u << bits) - 1);
+}
+
+static inline bool in_range(const JoinHistogram *histogram, int key)
+{
+    return key >= histogram->low && key <= histogram->high;
+}
+
+// rows of one input, partitioned contiguously: partition p is [bounds[p], bounds[p + 1])
+typedef struct RadixInput
+{
+    const int *keys;
+    const size_t *positions;
+    size_t length;
+    int *out_keys;
+    size_t *out_positions;
+    size_t *counts; // per morsel and partition, then each morsel's write offsets
+    size_t *bounds;
+} RadixInput;
+
+typedef struct RadixPass
+{
+    RadixInput *input;
+    const JoinHistogram *histogram;
+    unsigned int bits;
+    size_t fanout;
+} RadixPass;
+
+static void radix_count_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    RadixPass *pass = (RadixPass *)arg;
+    const int *keys = pass->input->keys;
+    size_t *counts = pass->input->counts + morsel * pass->fanout;
+    for (size_t i = start; i < end; i++)
+    {
+        if (in_range(pass->histogram, keys[i]))
+            counts[radix_digit(keys[i], 0, pass->bits)]++;
+    }
+}
+
+static void radix_scatter_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    RadixPass *pass = (RadixPass *)arg;
+    RadixInput *input = pass->input;
+    size_t *offsets = input->counts + morsel * pass->fanout;
+    for (size_t i = start; i < end; i++)
+    {
+        int key = input->keys[i];
+        if (!in_range(pass->histogram, key))
+            continue;
+        size_t o = offsets[radix_digit(key, 0, pass->bits)]++;
+        input->out_keys[o] = key;
+        input->out_positions[o] = input->positions[i];
+    }
+}
+
+// first pass over one input on all cores: count, prefix sum, scatter
+static void radix_partition(RadixInput *input, const JoinHistogram *histogram, unsigned int bits)
+{
+    RadixPass pass = {input, histogram, bits, (size_t)1 << bits};
+    size_t morsels = num_morsels(input->length, MORSEL_SIZE);
+    input->counts = calloc(morsels * pass.fanout, sizeof(size_t));
+    input->bounds = malloc((pass.fanout + 1) * sizeof(size_t));
+    run_morsels(input->length, MORSEL_SIZE, &radix_count_morsel, &pass);
+    // partition-major, morsel-minor: each partition is contiguous and each morsel writes its own slice of it
+    size_t offset = 0;
+    for (size_t p = 0; p < pass.fanout; p++)
+    {
+        input->bounds[p] = offset;
+        for (size_t m = 0; m < morsels; m++)
+        {
+            size_t count = input->counts[m * pass.fanout + p];
+            input->counts[m * pass.fanout + p] = offset;
+            offset += count;
+        }
+    }
+    input->bounds[pass.fanout] = offset;
+    input->out_keys = malloc((offset > 0 ? offset : 1) * sizeof(int));
+    input->out_positions = malloc((offset > 0 ? offset : 1) * sizeof(size_t));
+    run_morsels(input->length, MORSEL_SIZE, &radix_scatter_morsel, &pass);
+    free(input->counts);
+}
+
+// second pass over one first-pass partition, on the calling worker
+static void radix_subpartition(const int *keys, const size_t *positions, size_t length, unsigned int shift, unsigned int bits,
+                               int *out_keys, size_t *out_positions, size_t *bounds)
+{
+    size_t fanout = (size_t)1 << bits;
+    memset(bounds, 0, (fanout + 1) * sizeof(size_t));
+    for (size_t i = 0; i < length; i++)
+        bounds[radix_digit(keys[i], shift, bits) + 1]++;
+    for (size_t p = 0; p < fanout; p++)
+        bounds[p + 1] += bounds[p];
+    // bounds[p] advances past partition p while scattering, and ends at the start of p + 1
+    for (size_t i = 0; i < length; i++)
+    {
+        size_t o = bounds[radix_digit(keys[i], shift, bits)]++;
+        out_keys[o] = keys[i];
+        out_positions[o] = positions[i];
+    }
+    memmove(bounds + 1, bounds, fanout * sizeof(size_t));
+    bounds[0] = 0;
+}
+
+typedef struct RadixJoin
+{
+    RadixInput *left;
+    RadixInput *right;
+    unsigned int first_bits;
+    unsigned int second_bits;
+    PositionBuffer *left_outs;
+    PositionBuffer *right_outs;
+} RadixJoin;
+
+// one first-pass partition per morsel
+static void radix_join_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    (void)start;
+    (void)end;
+    RadixJoin *join = (RadixJoin *)arg;
+    size_t left_start = join->left->bounds[morsel], left_length = join->left->bounds[morsel + 1] - left_start;
+    size_t right_start = join->right->bounds[morsel], right_length = join->right->bounds[morsel + 1] - right_start;
+    PositionBuffer *left_out = &join->left_outs[morsel];
+    PositionBuffer *right_out = &join->right_outs[morsel];
+    position_buffer_init(left_out, left_length > right_length ? left_length : right_length);
+    position_buffer_init(right_out, left_length > right_length ? left_length : right_length);
+    if (left_length == 0 || right_length == 0)
+        return;
+    const int *left_keys = join->left->out_keys + left_start;
+    const size_t *left_positions = join->left->out_positions + left_start;
+    const int *right_keys = join->right->out_keys + right_start;
+    const size_t *right_positions = join->right->out_positions + right_start;
+
+    size_t fanout = (size_t)1 << join->second_bits;
+    size_t *left_bounds = malloc((fanout + 1) * sizeof(size_t));
+    size_t *right_bounds = malloc((fanout + 1) * sizeof(size_t));
+    int *left_scratch_keys = NULL, *right_scratch_keys = NULL;
+    size_t *left_scratch_positions = NULL, *right_scratch_positions = NULL;
+    if (join->second_bits > 0)
+    {
+        left_scratch_keys = malloc(left_length * sizeof(int));
+        left_scratch_positions = malloc(left_length * sizeof(size_t));
+        right_scratch_keys = malloc(right_length * sizeof(int));
+        right_scratch_positions = malloc(right_length * sizeof(size_t));
+        radix_subpartition(left_keys, left_positions, left_length, join->first_bits, join->second_bits,
+                           left_scratch_keys, left_scratch_positions, left_bounds);
+        radix_subpartition(right_keys, right_positions, right_length, join->first_bits, join->second_bits,
+                           right_scratch_keys, right_scratch_positions, right_bounds);
+        left_keys = left_scratch_keys;
+        left_positions = left_scratch_positions;
+        right_keys = right_scratch_keys;
+        right_positions = right_scratch_positions;
+    }
+    else
+    {
+        left_bounds[0] = right_bounds[0] = 0;
+        left_bounds[1] = left_length;
+        right_bounds[1] = right_length;
+    }
+
+    // the hash table is sized for the largest build side any final partition can have
+    size_t max_build = left_length < right_length ? left_length : right_length;
+    JoinTable table;
+    join_table_init(&table, max_build);
+    for (size_t q = 0; q < fanout; q++)
+    {
+        size_t ls = left_bounds[q], ln = left_bounds[q + 1] - ls;
+        size_t rs = right_bounds[q], rn = right_bounds[q + 1] - rs;
+        if (ln == 0 || rn == 0)
+            continue;
+        // always build on the smaller side, which never exceeds max_build
+        if (rn <= ln)
+            hash_join(&table, right_keys + rs, right_positions + rs, rn, left_keys + ls, left_positions + ls, ln, right_out, left_out);
+        else
+            hash_join(&table, left_keys + ls, left_positions + ls, ln, right_keys + rs, right_positions + rs, rn, left_out, right_out);
+    }
+    join_table_free(&table);
+    free(left_bounds);
+    free(right_bounds);
+    free(left_scratch_keys);
+    free(left_scratch_positions);
+    free(right_scratch_keys);
+    free(right_scratch_positions);
+}
+
+typedef struct RadixGather
+{
+    PositionBuffer *left_outs;
+    PositionBuffer *right_outs;
+    size_t *offsets;
+    PositionBuffer *left_out;
+    PositionBuffer *right_out;
+} RadixGather;
+
+// copies one partition's pairs to their final offset, the outputs are already sized
+static void radix_gather_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    (void)start;
+    (void)end;
+    RadixGather *gather = (RadixGather *)arg;
+    size_t length = gather->left_outs[morsel].length;
+    memcpy(gather->left_out->data + gather->offsets[morsel], gather->left_outs[morsel].data, length * sizeof(size_t));
+    memcpy(gather->right_out->data + gather->offsets[morsel], gather->right_outs[morsel].data, length * sizeof(size_t));
+    free(gather->left_outs[morsel].data);
+    free(gather->right_outs[morsel].data);
+}
+
+void radix_join(const int *left, const size_t *left_positions, size_t left_length,
+                const int *right, const size_t *right_positions, size_t right_length,
+                const JoinHistogram *histogram, PositionBuffer *left_out, PositionBuffer *right_out)
+{
+    if (histogram->empty)
+    {
+        position_buffer_init(left_out, 0);
+        position_buffer_init(right_out, 0);
+        return;
+    }
+    // enough radix bits that the smaller side's partitions fit the cache, RADIX_BITS_PER_PASS per pass
+    size_t build = 0, probe = 0;
+    for (size_t b = 0; b < JOIN_HISTOGRAM_BUCKETS; b++)
+    {
+        build += histogram->left[b];
+        probe += histogram->right[b];
+    }
+    if (probe < build)
+        build = probe;
+    size_t rows_per_partition = RADIX_PARTITION_BYTES / RADIX_BUILD_ROW_BYTES;
+    unsigned int bits = 0;
+    while (bits < RADIX_BITS_PER_PASS * RADIX_MAX_PASSES && (build >> bits) > rows_per_partition)
+        bits++;
+    unsigned int first_bits = bits < RADIX_BITS_PER_PASS ? bits : RADIX_BITS_PER_PASS;
+
+    RadixInput left_input = {left, left_positions, left_length, NULL, NULL, NULL, NULL};
+    RadixInput right_input = {right, right_positions, right_length, NULL, NULL, NULL, NULL};
+    radix_partition(&left_input, histogram, first_bits);
+    radix_partition(&right_input, histogram, first_bits);
+
+    size_t fanout = (size_t)1 << first_bits;
+    RadixJoin join = {&left_input, &right_input, first_bits, bits - first_bits,
+                      malloc(fanout * sizeof(PositionBuffer)), malloc(fanout * sizeof(PositionBuffer))};
+    run_morsels(fanout, 1, &radix_join_morsel, &join);
+
+    // a prefix sum over the partition outputs gives each its final offset, then they are copied in parallel
+    RadixGather gather = {join.left_outs, join.right_outs, malloc(fanout * sizeof(size_t)), left_out, right_out};
+    size_t total = 0;
+    for (size_t p = 0; p < fanout; p++)
+    {
+        gather.offsets[p] = total;
+        total += join.left_outs[p].length;
+    }
+    position_buffer_init(left_out, total);
+    position_buffer_init(right_out, total);
+    left_out->length = right_out->length = total;
+    run_morsels(fanout, 1, &radix_gather_morsel, &gather);
+    free(gather.offsets);
+    free(join.left_outs);
+    free(join.right_outs);
+    free(left_input.out_keys);
+    free(left_input.out_positions);
+    free(left_input.bounds);
+    free(right_input.out_keys);
+    free(right_input.out_positions);
+    free(right_input.bounds);
+}
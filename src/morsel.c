@@ -0,0 +1,106 @@
+#include <pthread.h>
+#include <unistd.h>
+
+#include "morsel.h"
+#include "threadpool.h"
+
+#define MORSEL_QUEUE 4096
+
+typedef struct MorselJob
+{
+    size_t length;
+    size_t morsel_size;
+    size_t num_morsels;
+    size_t next_morsel; // claimed with an atomic fetch-and-add
+    int active_helpers;
+    pthread_mutex_t mutex;
+    pthread_cond_t finished;
+    morsel_fn fn;
+    void *arg;
+} MorselJob;
+
+// workers shared by every morsel-driven operator, created on first use
+static threadpool_t *morsel_pool = NULL;
+static int morsel_workers = 0;
+static pthread_once_t morsel_once = PTHREAD_ONCE_INIT;
+
+static void morsel_init(void)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    // the calling thread works too, so one worker less than the number of cores
+    morsel_workers = cores > 1 ? (int)(cores - 1) : 0;
+    if (morsel_workers > MAX_THREADS)
+        morsel_workers = MAX_THREADS;
+    if (morsel_workers > 0 && (morsel_pool = threadpool_create(morsel_workers, MORSEL_QUEUE, 0)) == NULL)
+        morsel_workers = 0;
+}
+
+size_t num_morsels(size_t length, size_t morsel_size)
+{
+    return (length + morsel_size - 1) / morsel_size;
+}
+
+static void run_claimed_morsels(MorselJob *job)
+{
+    size_t morsel;
+    while ((morsel = __sync_fetch_and_add(&job->next_morsel, 1)) < job->num_morsels)
+    {
+        size_t start = morsel * job->morsel_size;
+        size_t end = start + job->morsel_size < job->length ? start + job->morsel_size : job->length;
+        job->fn(job->arg, morsel, start, end);
+    }
+}
+
+static void morsel_helper(void *args)
+{
+    MorselJob *job = (MorselJob *)args;
+    run_claimed_morsels(job);
+    pthread_mutex_lock(&job->mutex);
+    if (--job->active_helpers == 0)
+        pthread_cond_signal(&job->finished);
+    pthread_mutex_unlock(&job->mutex);
+}
+
+void run_morsels(size_t length, size_t morsel_size, morsel_fn fn, void *arg)
+{
+    pthread_once(&morsel_once, morsel_init);
+    MorselJob job;
+    job.length = length;
+    job.morsel_size = morsel_size;
+    job.num_morsels = num_morsels(length, morsel_size);
+    job.next_morsel = 0;
+    job.fn = fn;
+    job.arg = arg;
+
+    int helpers = morsel_workers;
+    // the caller takes the first morsel, so never wake more helpers than there are morsels left
+    if (job.num_morsels <= (size_t)helpers)
+        helpers = job.num_morsels > 0 ? (int)job.num_morsels - 1 : 0;
+    if (helpers == 0)
+    {
+        run_claimed_morsels(&job);
+        return;
+    }
+
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.finished, NULL);
+    job.active_helpers = helpers;
+    for (int i = 0; i < helpers; i++)
+    {
+        if (threadpool_add(morsel_pool, &morsel_helper, (void *)&job, 0) != 0)
+        {
+            // the caller picks up the morsels of helpers that could not be queued
+            pthread_mutex_lock(&job.mutex);
+            job.active_helpers -= helpers - i;
+            pthread_mutex_unlock(&job.mutex);
+            break;
+        }
+    }
+    run_claimed_morsels(&job);
+    pthread_mutex_lock(&job.mutex);
+    while (job.active_helpers > 0)
+        pthread_cond_wait(&job.finished, &job.mutex);
+    pthread_mutex_unlock(&job.mutex);
+    pthread_mutex_destroy(&job.mutex);
+    pthread_cond_destroy(&job.finished);
+}
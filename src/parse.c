@@ -12,6 +12,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <errno.h>
 #include "cs165_api.h"
 #include "parse.h"
 #include "utils.h"
@@ -381,74 +382,153 @@ DbOperator *parse_load(char *query_command, message *send_message)
     return dbo;
 }
 
-DbOperator *parse_fetch(char *intermediate, char *query_command, message *send_message)
+DbOperator *parse_fetch(char *intermediates, char *query_command, message *send_message)
 {
+    // f=fetch(db.tbl.col,s) or f1,f2,f3=fetch(db.tbl.(c1,c2,c3),s)
     cs165_log(stdout, "QUERY: %s", query_command);
-    char *token = NULL;
-    // check for leading '('
-    if (strncmp(query_command, "(", 1) == 0)
+    if (strncmp(query_command, "(", 1) != 0)
     {
-        query_command++;
-        char **command_index = &query_command;
-        // parse table input
-        char *name = next_token(command_index, &send_message->status);
-        if (send_message->status == INCORRECT_FORMAT)
-        {
-            return NULL;
-        }
-        char *db_name = sep_token(&name, ".", &send_message->status);
-        char *table_name = sep_token(&name, ".", &send_message->status);
-        char *column_name = sep_token(&name, ".", &send_message->status);
-        if (strcmp(db_name, current_db->name) != 0)
-        {
-            send_message->status = OBJECT_NOT_FOUND;
-        }
+        send_message->status = UNKNOWN_COMMAND;
+        return NULL;
+    }
+    if (intermediates == NULL)
+    {
+        send_message->status = INCORRECT_FORMAT;
+        return NULL;
+    }
+    query_command++;
+    // the positions are the last argument, the column list may hold commas of its own
+    char *positions = strrchr(query_command, ',');
+    int last_char = positions ? (int)strlen(positions) - 1 : -1;
+    if (last_char < 1 || positions[last_char] != ')')
+    {
+        send_message->status = INCORRECT_FORMAT;
+        return NULL;
+    }
+    *positions++ = '\0';
+    // replace final ')' with null-termination character.
+    positions[last_char - 1] = '\0';
 
-        // lookup the table and make sure it exists.
-        // TODO: implement lookup table
-        Table *fetch_table = lookup_table(table_name);
-        if (fetch_table == NULL)
+    char *name = query_command;
+    char *db_name = sep_token(&name, ".", &send_message->status);
+    char *table_name = sep_token(&name, ".", &send_message->status);
+    if (name == NULL || strcmp(db_name, current_db->name) != 0)
+    {
+        send_message->status = OBJECT_NOT_FOUND;
+        return NULL;
+    }
+    Table *fetch_table = lookup_table(table_name);
+    if (fetch_table == NULL)
+    {
+        send_message->status = OBJECT_NOT_FOUND;
+        return NULL;
+    }
+    name = trim_parenthesis(name);
+
+    DbOperator *dbo = malloc(sizeof(DbOperator));
+    dbo->type = FETCH;
+    FetchOperator *fetch = &dbo->operator_fields.fetch_operator;
+    fetch->num_columns = 0;
+    char *column_name;
+    while ((column_name = strsep(&name, ",")) != NULL)
+    {
+        char *intermediate = strsep(&intermediates, ",");
+        Column *column = lookup_column(fetch_table, column_name);
+        if (fetch->num_columns == MAX_FETCH_COLUMNS || intermediate == NULL || column == NULL)
         {
-            send_message->status = OBJECT_NOT_FOUND;
+            send_message->status = column == NULL ? OBJECT_NOT_FOUND : INCORRECT_FORMAT;
+            free(dbo);
             return NULL;
         }
+        fetch->columns[fetch->num_columns] = column;
+        strcpy(fetch->intermediates[fetch->num_columns], intermediate);
+        fetch->num_columns++;
+    }
+    // one handle per column
+    if (intermediates != NULL || fetch->num_columns == 0)
+    {
+        send_message->status = INCORRECT_FORMAT;
+        free(dbo);
+        return NULL;
+    }
+    strcpy(fetch->positions, positions);
+    return dbo;
+}
 
-        Column *fetch_column = lookup_column(fetch_table, column_name);
-        // make insert operator.
-        DbOperator *dbo = malloc(sizeof(DbOperator));
-        dbo->type = FETCH;
-        strcpy(dbo->operator_fields.fetch_operator.intermediate, intermediate);
-        dbo->operator_fields.fetch_operator.column = fetch_column;
-        // parse inputs until we reach the end. Turn each given string into an integer.
-        if ((token = sep_token(command_index, ",", &send_message->status)) != NULL)
+/*
+ * select(and(db.tbl.c1,low,high),(db.tbl.c2,low,high),...) and the same with or(...):
+ * one operator over all predicates instead of a chain of selects and fetches
+ */
+DbOperator *parse_multi_select(char *intermediate, char *query_command, message *send_message)
+{
+    char *tokenizer_copy, *to_free;
+    // Since strsep destroys input, we create a copy of our input.
+    tokenizer_copy = to_free = malloc((strlen(query_command) + 1) * sizeof(char));
+    strcpy(tokenizer_copy, query_command);
+    DbOperator *dbo = malloc(sizeof(DbOperator));
+    dbo->type = MULTI_SELECT;
+    MultiSelectOperator *multi_select = &dbo->operator_fields.multi_select_operator;
+    strcpy(multi_select->intermediate, intermediate);
+    // skip the leading "(and(" or "(or("
+    multi_select->disjunctive = strncmp(tokenizer_copy, "(or(", 4) == 0;
+    tokenizer_copy += multi_select->disjunctive ? 4 : 5;
+    multi_select->num_predicates = 0;
+    Table *table = NULL;
+    message_status status = OK_DONE;
+    while (tokenizer_copy != NULL && status == OK_DONE)
+    {
+        char *name = next_token(&tokenizer_copy, &status);
+        char *low_token = next_token(&tokenizer_copy, &status);
+        char *high_token = next_token(&tokenizer_copy, &status);
+        if (status == INCORRECT_FORMAT || multi_select->num_predicates == MAX_SELECT_PREDICATES)
         {
-            int last_char = strlen(token) - 1;
-            if (last_char < 0 || token[last_char] != ')')
-            {
-                free(dbo);
-                return NULL;
-            }
-            // replace final ')' with null-termination character.
-            token[last_char] = '\0';
-            dbo->operator_fields.fetch_operator.positions = token;
+            status = INCORRECT_FORMAT;
+            break;
         }
-        else
+        name = trim_parenthesis(name);
+        high_token = trim_parenthesis(high_token);
+        char *db_name = sep_token(&name, ".", &status);
+        char *table_name = sep_token(&name, ".", &status);
+        char *column_name = sep_token(&name, ".", &status);
+        if (status == INCORRECT_FORMAT)
+            break;
+        // every predicate has to address rows of the same table
+        Table *predicate_table = lookup_table(table_name);
+        Column *column = predicate_table ? lookup_column(predicate_table, column_name) : NULL;
+        if (strcmp(db_name, current_db->name) != 0 || column == NULL || (table != NULL && predicate_table != table))
         {
-            send_message->status = OBJECT_NOT_FOUND;
-            free(dbo);
-            return NULL;
+            status = OBJECT_NOT_FOUND;
+            break;
         }
-        return dbo;
+        table = predicate_table;
+        ColumnPredicate *predicate = &multi_select->predicates[multi_select->num_predicates++];
+        predicate->column = column;
+        if (strcmp(low_token, "null") == 0)
+            predicate->low = -__INT_MAX__ - 1;
+        else
+            predicate->low = atoi(low_token);
+        if (strcmp(high_token, "null") == 0)
+            predicate->high = __INT_MAX__;
+        else
+            predicate->high = atoi(high_token) - 1;
     }
-    else
+    free(to_free);
+    if (status != OK_DONE)
     {
-        send_message->status = UNKNOWN_COMMAND;
+        send_message->status = status;
+        free(dbo);
         return NULL;
     }
+    multi_select->column_length = table->table_length;
+    return dbo;
 }
 
 DbOperator *parse_select(char *intermediate, char *query_command, message *send_message)
 {
+    if (strncmp(query_command, "(and(", 5) == 0 || strncmp(query_command, "(or(", 4) == 0)
+    {
+        return parse_multi_select(intermediate, query_command, send_message);
+    }
     char *token = NULL;
     char *tokenizer_copy, *to_free;
     // Since strsep destroys input, we create a copy of our input.
@@ -618,8 +698,153 @@ DbOperator *parse_select(char *intermediate, char *query_command, message *send_
     }
 }
 
+/*
+ * agg(fetch(db.tbl.col2,select(db.tbl.col1,low,high))) is run as one fused operator
+ * instead of three statements with two materialized intermediates
+ */
+DbOperator *parse_fused_aggregate(char *intermediate, char *query_command, AggregateType aggregate_type, message *send_message)
+{
+    if (aggregate_type == ADD || aggregate_type == SUB)
+    {
+        // element-wise operators produce a vector, there is no reduction to fuse into
+        send_message->status = INCORRECT_FORMAT;
+        return NULL;
+    }
+    // count(select(...)) counts the selected rows, other aggregates need the values of a fetch
+    bool fetched = strncmp(query_command, "(fetch(", 7) == 0;
+    if (!fetched && aggregate_type != COUNT)
+    {
+        send_message->status = INCORRECT_FORMAT;
+        return NULL;
+    }
+    char *tokenizer_copy, *to_free;
+    // Since strsep destroys input, we create a copy of our input.
+    tokenizer_copy = to_free = malloc((strlen(query_command) + 1) * sizeof(char));
+    strcpy(tokenizer_copy, query_command);
+    // skip the leading "(fetch(", or the "(" of "(select("
+    tokenizer_copy += fetched ? 7 : 1;
+    char *fetch_name = fetched ? next_token(&tokenizer_copy, &send_message->status) : NULL;
+    char *select_name = next_token(&tokenizer_copy, &send_message->status);
+    char *low_token = next_token(&tokenizer_copy, &send_message->status);
+    char *high_token = next_token(&tokenizer_copy, &send_message->status);
+    if (send_message->status == INCORRECT_FORMAT || strncmp(select_name, "select(", 7) != 0)
+    {
+        send_message->status = INCORRECT_FORMAT;
+        free(to_free);
+        return NULL;
+    }
+    select_name += 7;
+    high_token = trim_parenthesis(high_token);
+    if (!fetched)
+    {
+        fetch_name = select_name;
+    }
+    char *fetch_db_name = sep_token(&fetch_name, ".", &send_message->status);
+    char *fetch_table_name = sep_token(&fetch_name, ".", &send_message->status);
+    char *fetch_column_name = sep_token(&fetch_name, ".", &send_message->status);
+    char *select_db_name = fetch_db_name;
+    char *select_table_name = fetch_table_name;
+    char *select_column_name = fetch_column_name;
+    if (fetched)
+    {
+        select_db_name = sep_token(&select_name, ".", &send_message->status);
+        select_table_name = sep_token(&select_name, ".", &send_message->status);
+        select_column_name = sep_token(&select_name, ".", &send_message->status);
+    }
+    if (send_message->status == INCORRECT_FORMAT)
+    {
+        free(to_free);
+        return NULL;
+    }
+    // positions of the select only address rows of the same table
+    Table *table = lookup_table(select_table_name);
+    if (strcmp(fetch_db_name, current_db->name) != 0 || strcmp(select_db_name, current_db->name) != 0 ||
+        strcmp(fetch_table_name, select_table_name) != 0 || table == NULL)
+    {
+        send_message->status = OBJECT_NOT_FOUND;
+        free(to_free);
+        return NULL;
+    }
+    Column *fetch_column = lookup_column(table, fetch_column_name);
+    Column *select_column = lookup_column(table, select_column_name);
+    if (fetch_column == NULL || select_column == NULL)
+    {
+        send_message->status = OBJECT_NOT_FOUND;
+        free(to_free);
+        return NULL;
+    }
+    DbOperator *dbo = malloc(sizeof(DbOperator));
+    dbo->type = FUSED_AGGREGATE;
+    strcpy(dbo->operator_fields.fused_aggregate_operator.intermediate, intermediate);
+    dbo->operator_fields.fused_aggregate_operator.aggregate_type = aggregate_type;
+    dbo->operator_fields.fused_aggregate_operator.select_column = select_column;
+    dbo->operator_fields.fused_aggregate_operator.fetch_column = fetch_column;
+    dbo->operator_fields.fused_aggregate_operator.column_length = table->table_length;
+    if (strcmp(low_token, "null") == 0)
+        dbo->operator_fields.fused_aggregate_operator.low = -__INT_MAX__ - 1;
+    else
+        dbo->operator_fields.fused_aggregate_operator.low = atoi(low_token);
+    if (strcmp(high_token, "null") == 0)
+        dbo->operator_fields.fused_aggregate_operator.high = __INT_MAX__;
+    else
+        dbo->operator_fields.fused_aggregate_operator.high = atoi(high_token) - 1;
+    free(to_free);
+    return dbo;
+}
+
+// a numeric literal as a one-value result: INT when it fits, LONG for larger integers, DOUBLE otherwise
+static Result *parse_constant(char *token)
+{
+    char *end;
+    errno = 0;
+    long integer = strtol(token, &end, 10);
+    if (end != token && *end == '\0' && errno == 0)
+    {
+        Result *constant = malloc(sizeof(Result));
+        constant->format = MATERIALIZED;
+        constant->num_tuples = 1;
+        if (integer >= -__INT_MAX__ - 1 && integer <= __INT_MAX__)
+        {
+            constant->data_type = INT;
+            constant->payload = malloc(sizeof(int));
+            *(int *)constant->payload = integer;
+        }
+        else
+        {
+            constant->data_type = LONG;
+            constant->payload = malloc(sizeof(long));
+            *(long *)constant->payload = integer;
+        }
+        return constant;
+    }
+    double real = strtod(token, &end);
+    if (end != token && *end == '\0')
+    {
+        Result *constant = malloc(sizeof(Result));
+        constant->format = MATERIALIZED;
+        constant->num_tuples = 1;
+        constant->data_type = DOUBLE;
+        constant->payload = malloc(sizeof(double));
+        *(double *)constant->payload = real;
+        return constant;
+    }
+    return NULL;
+}
+
+static GeneralizedColumn *constant_column(Result *constant)
+{
+    GeneralizedColumn *generalized_column = malloc(sizeof(GeneralizedColumn));
+    generalized_column->column_type = RESULT;
+    generalized_column->column_pointer.result = constant;
+    return generalized_column;
+}
+
 DbOperator *parse_aggregate(char *intermediate, char *query_command, AggregateType aggregate_type, message *send_message, ClientContext *client_context)
 {
+    if (strncmp(query_command, "(fetch(", 7) == 0 || strncmp(query_command, "(select(", 8) == 0)
+    {
+        return parse_fused_aggregate(intermediate, query_command, aggregate_type, send_message);
+    }
     char *tokenizer_copy, *to_free;
     // Since strsep destroys input, we create a copy of our input.
     tokenizer_copy = to_free = malloc((strlen(query_command) + 1) * sizeof(char));
@@ -670,6 +895,7 @@ DbOperator *parse_aggregate(char *intermediate, char *query_command, AggregateTy
             //printf("Type Number: %d\n", dbo->operator_fields.aggregate_operator.aggregate_type);
             dbo->operator_fields.aggregate_operator.variable_number = intermediate_number;
             dbo->operator_fields.aggregate_operator.gc1 = generalized_column;
+            dbo->operator_fields.aggregate_operator.constant = NULL;
             free(to_free);
             return dbo;
         }
@@ -679,10 +905,15 @@ DbOperator *parse_aggregate(char *intermediate, char *query_command, AggregateTy
             char *raw_intermediate1 = next_token(&tokenizer_copy, &send_message->status);
             char *raw_intermediate2 = next_token(&tokenizer_copy, &send_message->status);
             //printf("Raw intermediates %s  %s", raw_intermediate1, raw_intermediate2);
+            // one operand of an elementwise operator may be a literal, broadcast to every row
+            Result *constant = parse_constant(raw_intermediate1);
+            bool constant_first = constant != NULL;
+            if (!constant)
+                constant = parse_constant(raw_intermediate2);
             char *db_name1 = NULL;
             char *table_name1 = NULL;
             char *column_name1 = NULL;
-            if (strchr(raw_intermediate1, '.'))
+            if (!constant_first && strchr(raw_intermediate1, '.'))
             {
                 db_name1 = sep_token(&raw_intermediate1, ".", &send_message->status);
                 table_name1 = sep_token(&raw_intermediate1, ".", &send_message->status);
@@ -692,24 +923,23 @@ DbOperator *parse_aggregate(char *intermediate, char *query_command, AggregateTy
             char *db_name2 = NULL;
             char *table_name2 = NULL;
             char *column_name2 = NULL;
-            if (strchr(raw_intermediate2, '.'))
+            if ((!constant || constant_first) && strchr(raw_intermediate2, '.'))
             {
                 db_name2 = sep_token(&raw_intermediate2, ".", &send_message->status);
                 table_name2 = sep_token(&raw_intermediate2, ".", &send_message->status);
                 column_name2 = sep_token(&raw_intermediate2, ".", &send_message->status);
                 raw_intermediate2 = column_name2;
             }
-            GeneralizedColumn *generalized_column1 = lookup_variables(db_name1, table_name1, column_name1, raw_intermediate1, client_context);
-            if (!generalized_column1)
-            {
-                send_message->status = INCORRECT_FORMAT;
-                free(to_free);
-                return NULL;
-            }
-            GeneralizedColumn *generalized_column2 = lookup_variables(db_name2, table_name2, column_name2, raw_intermediate2, client_context);
-            if (!generalized_column2)
+            GeneralizedColumn *generalized_column1 = constant_first ? constant_column(constant) : lookup_variables(db_name1, table_name1, column_name1, raw_intermediate1, client_context);
+            GeneralizedColumn *generalized_column2 = constant && !constant_first ? constant_column(constant) : lookup_variables(db_name2, table_name2, column_name2, raw_intermediate2, client_context);
+            if (!generalized_column1 || !generalized_column2)
             {
                 send_message->status = INCORRECT_FORMAT;
+                if (constant)
+                {
+                    free(constant_first ? generalized_column1 : generalized_column2);
+                    free_result(constant);
+                }
                 free(to_free);
                 return NULL;
             }
@@ -720,6 +950,7 @@ DbOperator *parse_aggregate(char *intermediate, char *query_command, AggregateTy
             dbo->operator_fields.aggregate_operator.variable_number = intermediate_number;
             dbo->operator_fields.aggregate_operator.gc1 = generalized_column1;
             dbo->operator_fields.aggregate_operator.gc2 = generalized_column2;
+            dbo->operator_fields.aggregate_operator.constant = constant;
             //printf("Type Number: %d\n", dbo->operator_fields.aggregate_operator.aggregate_type);
             free(to_free);
             return dbo;
@@ -818,6 +1049,43 @@ DbOperator *parse_batch_end(message *send_message)
     return dbo;
 }
 
+// s=and(s1,s2) / s=or(s1,s2) over two position intermediates
+DbOperator *parse_position_set(char *intermediate, char *query_command, bool disjunctive, message *send_message)
+{
+    char *tokenizer_copy, *to_free;
+    // Since strsep destroys input, we create a copy of our input.
+    tokenizer_copy = to_free = malloc((strlen(query_command) + 1) * sizeof(char));
+    strcpy(tokenizer_copy, query_command);
+    // check for leading '('
+    if (strncmp(tokenizer_copy, "(", 1) == 0)
+    {
+        tokenizer_copy++;
+        int last_char = strlen(tokenizer_copy) - 1;
+        // replace final ')' with null-termination character.
+        if (tokenizer_copy[last_char] == ')')
+        {
+            tokenizer_copy[last_char] = '\0';
+        }
+    }
+    message_status status = OK_DONE;
+    char *left = next_token(&tokenizer_copy, &status);
+    char *right = next_token(&tokenizer_copy, &status);
+    if (intermediate == NULL || status == INCORRECT_FORMAT || tokenizer_copy != NULL)
+    {
+        send_message->status = INCORRECT_FORMAT;
+        free(to_free);
+        return NULL;
+    }
+    DbOperator *dbo = malloc(sizeof(DbOperator));
+    dbo->type = POSITION_SET;
+    strcpy(dbo->operator_fields.position_set_operator.intermediate, intermediate);
+    strcpy(dbo->operator_fields.position_set_operator.left, left);
+    strcpy(dbo->operator_fields.position_set_operator.right, right);
+    dbo->operator_fields.position_set_operator.disjunctive = disjunctive;
+    free(to_free);
+    return dbo;
+}
+
 DbOperator *parse_join(char *intermediates, char *query_command, message *send_message, ClientContext *client_context)
 {
     //        // t1,t2=join(f1,p1,f2,p2,nested-loop)
@@ -887,6 +1155,99 @@ DbOperator *parse_join(char *intermediates, char *query_command, message *send_m
     }
 }
 
+// a db.tbl.col column or a named intermediate of the client
+static GeneralizedColumn *lookup_operand(char *raw_intermediate, ClientContext *client_context, message_status *status)
+{
+    char *db_name = NULL;
+    char *table_name = NULL;
+    char *column_name = NULL;
+    if (strchr(raw_intermediate, '.'))
+    {
+        db_name = sep_token(&raw_intermediate, ".", status);
+        table_name = sep_token(&raw_intermediate, ".", status);
+        column_name = sep_token(&raw_intermediate, ".", status);
+        raw_intermediate = column_name;
+    }
+    return lookup_variables(db_name, table_name, column_name, raw_intermediate, client_context);
+}
+
+DbOperator *parse_group_by(char *intermediates, char *query_command, message *send_message, ClientContext *client_context)
+{
+    // k,a=group_by(keys,values,sum)
+    if (intermediates == NULL)
+    {
+        send_message->status = INCORRECT_FORMAT;
+        return NULL;
+    }
+    char *keys_name = sep_token(&intermediates, ",", &send_message->status);
+    char *aggregates_name = sep_token(&intermediates, ",", &send_message->status);
+    if (keys_name == NULL || aggregates_name == NULL)
+    {
+        send_message->status = INCORRECT_FORMAT;
+        return NULL;
+    }
+
+    char *tokenizer_copy, *to_free;
+    // Since strsep destroys input, we create a copy of our input.
+    tokenizer_copy = to_free = malloc((strlen(query_command) + 1) * sizeof(char));
+    strcpy(tokenizer_copy, query_command);
+    if (strncmp(tokenizer_copy, "(", 1) != 0)
+    {
+        send_message->status = UNKNOWN_COMMAND;
+        free(to_free);
+        return NULL;
+    }
+    tokenizer_copy++;
+    tokenizer_copy = trim_parenthesis(tokenizer_copy);
+    message_status status = OK_DONE;
+    char *raw_keys = next_token(&tokenizer_copy, &status);
+    char *raw_values = next_token(&tokenizer_copy, &status);
+    char *raw_aggregate = next_token(&tokenizer_copy, &status);
+    if (status == INCORRECT_FORMAT || raw_aggregate == NULL || tokenizer_copy != NULL)
+    {
+        send_message->status = INCORRECT_FORMAT;
+        free(to_free);
+        return NULL;
+    }
+    AggregateType aggregate_type;
+    if (strcmp(raw_aggregate, "sum") == 0)
+        aggregate_type = SUM;
+    else if (strcmp(raw_aggregate, "avg") == 0)
+        aggregate_type = AVG;
+    else if (strcmp(raw_aggregate, "min") == 0)
+        aggregate_type = MIN;
+    else if (strcmp(raw_aggregate, "max") == 0)
+        aggregate_type = MAX;
+    else
+    {
+        send_message->status = INCORRECT_FORMAT;
+        free(to_free);
+        return NULL;
+    }
+    GeneralizedColumn *keys = lookup_operand(raw_keys, client_context, &status);
+    GeneralizedColumn *values = lookup_operand(raw_values, client_context, &status);
+    if (!keys || !values)
+    {
+        if (keys && keys->column_type == COLUMN)
+            free(keys);
+        if (values && values->column_type == COLUMN)
+            free(values);
+        send_message->status = INCORRECT_FORMAT;
+        free(to_free);
+        return NULL;
+    }
+    DbOperator *dbo = malloc(sizeof(DbOperator));
+    dbo->type = GROUP_BY;
+    strcpy(dbo->operator_fields.group_by_operator.keys_name, keys_name);
+    strcpy(dbo->operator_fields.group_by_operator.aggregates_name, aggregates_name);
+    dbo->operator_fields.group_by_operator.aggregate_type = aggregate_type;
+    dbo->operator_fields.group_by_operator.keys = keys;
+    dbo->operator_fields.group_by_operator.values = values;
+    send_message->status = OK_DONE;
+    free(to_free);
+    return dbo;
+}
+
 /**
  * parse_command takes as input the send_message from the client and then
  * parses it into the appropriate query. Stores into send_message the
@@ -990,6 +1351,21 @@ DbOperator *parse_command(char *query_command, message *send_message, int client
         query_command += 3;
         dbo = parse_aggregate(handle, query_command, SUB, send_message, context);
     }
+    else if (strncmp(query_command, "mul", 3) == 0)
+    {
+        query_command += 3;
+        dbo = parse_aggregate(handle, query_command, MUL, send_message, context);
+    }
+    else if (strncmp(query_command, "div", 3) == 0)
+    {
+        query_command += 3;
+        dbo = parse_aggregate(handle, query_command, DIV, send_message, context);
+    }
+    else if (strncmp(query_command, "neg", 3) == 0)
+    {
+        query_command += 3;
+        dbo = parse_aggregate(handle, query_command, NEG, send_message, context);
+    }
     else if (strncmp(query_command, "min", 3) == 0)
     {
         query_command += 3;
@@ -1000,6 +1376,11 @@ DbOperator *parse_command(char *query_command, message *send_message, int client
         query_command += 3;
         dbo = parse_aggregate(handle, query_command, MAX, send_message, context);
     }
+    else if (strncmp(query_command, "count", 5) == 0)
+    {
+        query_command += 5;
+        dbo = parse_aggregate(handle, query_command, COUNT, send_message, context);
+    }
     else if (strncmp(query_command, "print", 5) == 0)
     {
         query_command += 5;
@@ -1017,12 +1398,27 @@ DbOperator *parse_command(char *query_command, message *send_message, int client
     {
         dbo = parse_batch_end(send_message);
     }
+    else if (strncmp(query_command, "and(", 4) == 0)
+    {
+        query_command += 3;
+        dbo = parse_position_set(handle, query_command, false, send_message);
+    }
+    else if (strncmp(query_command, "or(", 3) == 0)
+    {
+        query_command += 2;
+        dbo = parse_position_set(handle, query_command, true, send_message);
+    }
     else if (strncmp(query_command, "join", 4) == 0)
     {
         // t1,t2=join(f1,p1,f2,p2,nested-loop)
         query_command += 4;
         dbo = parse_join(handle, query_command, send_message, context);
     }
+    else if (strncmp(query_command, "group_by", 8) == 0)
+    {
+        query_command += 8;
+        dbo = parse_group_by(handle, query_command, send_message, context);
+    }
     if (dbo == NULL)
     {
         return dbo;
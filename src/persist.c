@@ -40,6 +40,12 @@ int load_database()
         {
             Column *current_column = &(current_table->columns[j]);
             fread(current_column, sizeof(Column), 1, fp);
+            // pointers were persisted with the struct, only the ones loaded below are valid
+            current_column->index = NULL;
+            current_column->histogram = NULL;
+            current_column->btree_root = NULL;
+            current_column->zone_map = NULL;
+            current_column->mapping = NULL;
             if (current_column->clustered)
             {
                 // printf("clustered: %s\n", current_column->name);
@@ -56,6 +62,15 @@ int load_database()
                 load_index(current_table->name, current_column->name, current_column);
             }
             map_column(current_table, current_column);
+            if (load_zone_map(current_table->name, current_column->name, current_column) == -1)
+            {
+                build_zone_map(current_column);
+            }
+            // statistics that disagree with the column length are rebuilt from the data
+            if (current_column->stats.count != current_column->length)
+            {
+                build_column_stats(current_column);
+            }
             if (current_column->btree)
             {
                 current_column->btree_root = load_btree(current_table->name, current_column->name);
@@ -118,6 +133,12 @@ int map_column(Table *table, Column *column)
         cs165_log(stdout, "Cannot write zero-byte at the end of column page file %s\n", column_path);
         return -1;
     }
+    // a column mapped again without being persisted first (reload) moves off its old mapping
+    if (column->mapping)
+    {
+        release_mapping(column->mapping);
+        column->mapping = NULL;
+    }
     column->data = mmap(0, table->table_length_capacity * sizeof(int), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
     if (column->data == MAP_FAILED)
     {
@@ -125,6 +146,10 @@ int map_column(Table *table, Column *column)
         cs165_log(stdout, "Memory mapping failed column page file %s\n", column_path);
         return -1;
     }
+    column->mapping = malloc(sizeof(ColumnMapping));
+    column->mapping->data = column->data;
+    column->mapping->size = table->table_length_capacity * sizeof(int);
+    column->mapping->refs = 1;
     if (msync(column->data, table->table_length_capacity * sizeof(int), MS_SYNC) == -1)
     {
         cs165_log(stdout, "Memory syncing the file %s failed.\n", column_path);
@@ -135,6 +160,23 @@ int map_column(Table *table, Column *column)
     return 0;
 }
 
+ColumnMapping *acquire_mapping(Column *column)
+{
+    column->mapping->refs++;
+    return column->mapping;
+}
+
+int release_mapping(ColumnMapping *mapping)
+{
+    if (--mapping->refs > 0)
+    {
+        return 0;
+    }
+    int result = munmap(mapping->data, mapping->size);
+    free(mapping);
+    return result;
+}
+
 int syncing_column(Column *column, Table *table)
 {
     // printf("Syncing column %s \n",column->name);
@@ -210,6 +252,10 @@ int persist_table(Table *current_table, FILE *fp)
         {
             persist_btree(current_column->btree_root, current_table->name, current_column->name);
         }
+        if (current_column->zone_map)
+        {
+            persist_zone_map(current_table->name, current_column->name, current_column);
+        }
     }
 
     for (size_t j = 0; j < current_table->col_count; j++)
@@ -271,6 +317,74 @@ int persist_index(char *table_name, char *column_name, Column *current_column)
     return return_flag;
 }
 
+int load_zone_map(char *table_name, char *column_name, Column *current_column)
+{
+    char zone_map_path[MAX_COLUMN_PATH];
+    int return_flag = 0;
+    strcpy(zone_map_path, COLUMN_PATH);
+    strcat(zone_map_path, table_name);
+    strcat(zone_map_path, PATH_SEP);
+    strcat(zone_map_path, column_name);
+    strcat(zone_map_path, ".zone");
+    FILE *fp = fopen(zone_map_path, "rb");
+    if (!fp)
+    {
+        return_flag = -1;
+        return return_flag;
+    }
+    ZoneMap *zone_map = malloc(sizeof(ZoneMap));
+    // a zone map that does not cover the column is stale, the caller rebuilds it
+    if (fread(&zone_map->num_zones, sizeof(size_t), 1, fp) != 1 ||
+        zone_map->num_zones != (current_column->length + ZONE_SIZE - 1) / ZONE_SIZE)
+    {
+        free(zone_map);
+        fclose(fp);
+        return_flag = -1;
+        return return_flag;
+    }
+    zone_map->capacity = zone_map->num_zones;
+    zone_map->min = malloc(zone_map->capacity * sizeof(int));
+    zone_map->max = malloc(zone_map->capacity * sizeof(int));
+    // truncated bounds are treated like a stale zone map
+    if (fread(zone_map->min, sizeof(int), zone_map->num_zones, fp) != zone_map->num_zones ||
+        fread(zone_map->max, sizeof(int), zone_map->num_zones, fp) != zone_map->num_zones)
+    {
+        free(zone_map->min);
+        free(zone_map->max);
+        free(zone_map);
+        fclose(fp);
+        return_flag = -1;
+        return return_flag;
+    }
+    fclose(fp);
+    current_column->zone_map = zone_map;
+    return return_flag;
+}
+
+int persist_zone_map(char *table_name, char *column_name, Column *current_column)
+{
+    char zone_map_path[MAX_COLUMN_PATH];
+    int return_flag = 0;
+    strcpy(zone_map_path, COLUMN_PATH);
+    strcat(zone_map_path, table_name);
+    strcat(zone_map_path, PATH_SEP);
+    strcat(zone_map_path, column_name);
+    strcat(zone_map_path, ".zone");
+    // stored next to the column's .data file: zone count, then the mins, then the maxes
+    FILE *fp = fopen(zone_map_path, "wb");
+    if (!fp)
+    {
+        return_flag = -1;
+        return return_flag;
+    }
+    ZoneMap *zone_map = current_column->zone_map;
+    fwrite(&zone_map->num_zones, sizeof(size_t), 1, fp);
+    fwrite(zone_map->min, sizeof(int), zone_map->num_zones, fp);
+    fwrite(zone_map->max, sizeof(int), zone_map->num_zones, fp);
+    fclose(fp);
+    return return_flag;
+}
+
 int persist_column(Table *current_table, Column *current_column)
 {
     // unmap column file
@@ -286,7 +400,10 @@ int persist_column(Table *current_table, Column *current_column)
         cs165_log(stdout, "Memory syncing the file %s failed.\n", column_path);
         return -1;
     }
-    if (munmap(current_column->data, current_table->table_length_capacity * sizeof(int)) == -1)
+    // views still reading the old mapping keep it alive
+    int result = release_mapping(current_column->mapping);
+    current_column->mapping = NULL;
+    if (result == -1)
     {
         cs165_log(stdout, "Unmapping the file %s failed.\n", column_path);
         return -1;
@@ -317,6 +434,7 @@ int free_database()
             {
                 deallocate_btree(current_column->btree_root);
             }
+            free_zone_map(current_column);
         }
         free(current_table->columns);
     }
@@ -0,0 +1,441 @@
+#include <limits.h>
+#include <string.h>
+
+#include "pipeline.h"
+#include "scan.h"
+#include "morsel.h"
+#include "bitmap.h"
+#include "fetch.h"
+
+static PipelineNode *create_node(PipelineNodeType type, DataType data_type)
+{
+    PipelineNode *node = calloc(1, sizeof(PipelineNode));
+    node->type = type;
+    node->refs = 1;
+    node->data_type = data_type;
+    return node;
+}
+
+static PipelineNode *retain_node(PipelineNode *node)
+{
+    node->refs++;
+    return node;
+}
+
+static bool is_positions(PipelineNode *node)
+{
+    return node->type == SCAN_NODE || node->type == FILTER_NODE;
+}
+
+PipelineNode *pipeline_scan(Column *column, size_t column_length, int low, int high)
+{
+    PipelineNode *node = create_node(SCAN_NODE, LONG);
+    node->column = column;
+    node->column_length = column_length;
+    node->low = low;
+    node->high = high;
+    // source and domain point back at the node itself and hold no reference
+    node->source = node;
+    node->domain = node;
+    return node;
+}
+
+PipelineNode *pipeline_filter(PipelineNode *positions, PipelineNode *values, int low, int high)
+{
+    if (!is_positions(positions) || values->domain != positions)
+        return NULL;
+    PipelineNode *node = create_node(FILTER_NODE, LONG);
+    node->inputs[0] = retain_node(positions);
+    node->inputs[1] = retain_node(values);
+    node->low = low;
+    node->high = high;
+    node->source = positions->source;
+    node->domain = node;
+    return node;
+}
+
+PipelineNode *pipeline_fetch(Column *column, PipelineNode *positions)
+{
+    if (!is_positions(positions))
+        return NULL;
+    PipelineNode *node = create_node(FETCH_NODE, INT);
+    node->inputs[0] = retain_node(positions);
+    node->column = column;
+    node->source = positions->source;
+    node->domain = positions;
+    return node;
+}
+
+PipelineNode *pipeline_arith(AggregateType aggregate_type, PipelineNode *left, PipelineNode *right)
+{
+    if (!left->domain || left->domain != right->domain)
+        return NULL;
+    // int and long operands add up to long, as in execute_aggregate
+    PipelineNode *node = create_node(ARITH_NODE, LONG);
+    node->inputs[0] = retain_node(left);
+    node->inputs[1] = retain_node(right);
+    node->aggregate_type = aggregate_type;
+    node->source = left->source;
+    node->domain = left->domain;
+    return node;
+}
+
+PipelineNode *pipeline_aggregate(AggregateType aggregate_type, PipelineNode *input)
+{
+    if (!input->domain)
+        return NULL;
+    // data_type is the type being aggregated, it decides the type of the result
+    PipelineNode *node = create_node(AGGREGATE_NODE, input->data_type);
+    node->inputs[0] = retain_node(input);
+    node->aggregate_type = aggregate_type;
+    node->source = input->source;
+    return node;
+}
+
+Result *pipeline_result(PipelineNode *node)
+{
+    Result *result = malloc(sizeof(Result));
+    result->format = DEFERRED;
+    result->data_type = node->data_type;
+    result->num_tuples = 0;
+    result->payload = node;
+    return result;
+}
+
+void pipeline_release(PipelineNode *node)
+{
+    if (--node->refs > 0)
+        return;
+    for (int i = 0; i < 2; i++)
+    {
+        if (node->inputs[i])
+            pipeline_release(node->inputs[i]);
+    }
+    free(node);
+}
+
+typedef struct AggregatePartial
+{
+    long sum;
+    size_t count;
+    long min;
+    long max;
+} AggregatePartial;
+
+// what one morsel produced for one target
+typedef struct MorselOutput
+{
+    void *data;
+    size_t count;
+    size_t capacity;
+    AggregatePartial partial;
+} MorselOutput;
+
+typedef struct PipelineRun
+{
+    PipelineNode **nodes; // every node appears after its inputs
+    size_t num_nodes;
+    size_t (*input_index)[2];
+    size_t *target_index;
+    size_t num_targets;
+    MorselOutput *outputs; // num_targets per morsel
+} PipelineRun;
+
+static size_t node_index(PipelineRun *run, PipelineNode *node)
+{
+    for (size_t n = 0; n < run->num_nodes; n++)
+    {
+        if (run->nodes[n] == node)
+            return n;
+    }
+    return run->num_nodes;
+}
+
+static size_t collect_node(PipelineRun *run, PipelineNode *node)
+{
+    size_t index = node_index(run, node);
+    if (index < run->num_nodes)
+        return index;
+    size_t inputs[2] = {0, 0};
+    for (int i = 0; i < 2; i++)
+    {
+        if (node->inputs[i])
+            inputs[i] = collect_node(run, node->inputs[i]);
+    }
+    index = run->num_nodes++;
+    run->nodes = realloc(run->nodes, run->num_nodes * sizeof(PipelineNode *));
+    run->input_index = realloc(run->input_index, run->num_nodes * sizeof(size_t[2]));
+    run->nodes[index] = node;
+    run->input_index[index][0] = inputs[0];
+    run->input_index[index][1] = inputs[1];
+    return index;
+}
+
+static size_t element_size(DataType data_type)
+{
+    return data_type == INT ? sizeof(int) : sizeof(long);
+}
+
+static long vector_value(const void *vector, DataType data_type, size_t i)
+{
+    return data_type == INT ? ((const int *)vector)[i] : ((const long *)vector)[i];
+}
+
+// positions of the rows in [start, end) that pass the scan, pruned by the zone map
+static size_t scan_vector(PipelineNode *node, size_t start, size_t end, size_t *out)
+{
+    ZoneMap *zone_map = node->column->zone_map;
+    size_t zone = start / ZONE_SIZE;
+    if (zone_map && (zone_map->max[zone] < node->low || zone_map->min[zone] > node->high))
+        return 0;
+    if (zone_map && zone_map->min[zone] >= node->low && zone_map->max[zone] <= node->high)
+    {
+        for (size_t i = start; i < end; i++)
+            out[i - start] = i;
+        return end - start;
+    }
+    return select_range(node->column->data, start, end, node->low, node->high, out);
+}
+
+static void evaluate_node(PipelineRun *run, size_t n, void **vectors, size_t *counts, size_t start, size_t end)
+{
+    PipelineNode *node = run->nodes[n];
+    size_t in0 = run->input_index[n][0];
+    size_t in1 = run->input_index[n][1];
+    if (node->type == SCAN_NODE)
+    {
+        counts[n] = scan_vector(node, start, end, vectors[n]);
+    }
+    else if (node->type == FILTER_NODE)
+    {
+        size_t *positions = vectors[in0];
+        size_t *out = vectors[n];
+        DataType value_type = run->nodes[in1]->data_type;
+        size_t k = 0;
+        for (size_t i = 0; i < counts[in0]; i++)
+        {
+            long value = vector_value(vectors[in1], value_type, i);
+            out[k] = positions[i];
+            k += (value >= node->low) & (value <= node->high);
+        }
+        counts[n] = k;
+    }
+    else if (node->type == FETCH_NODE)
+    {
+        size_t *positions = vectors[in0];
+        int *out = vectors[n];
+        fetch_positions(node->column->data, positions, 0, counts[in0], out);
+        counts[n] = counts[in0];
+    }
+    else if (node->type == ARITH_NODE)
+    {
+        DataType left_type = run->nodes[in0]->data_type;
+        DataType right_type = run->nodes[in1]->data_type;
+        long *out = vectors[n];
+        for (size_t i = 0; i < counts[in0]; i++)
+        {
+            long left = vector_value(vectors[in0], left_type, i);
+            long right = vector_value(vectors[in1], right_type, i);
+            out[i] = node->aggregate_type == ADD ? left + right : left - right;
+        }
+        counts[n] = counts[in0];
+    }
+}
+
+static void pipeline_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    PipelineRun *run = (PipelineRun *)arg;
+    MorselOutput *outputs = run->outputs + morsel * run->num_targets;
+    void **vectors = malloc(run->num_nodes * sizeof(void *));
+    size_t *counts = calloc(run->num_nodes, sizeof(size_t));
+    for (size_t n = 0; n < run->num_nodes; n++)
+        vectors[n] = run->nodes[n]->type == AGGREGATE_NODE ? NULL : malloc(VECTOR_SIZE * element_size(run->nodes[n]->data_type));
+    for (size_t t = 0; t < run->num_targets; t++)
+    {
+        MorselOutput empty = {NULL, 0, 0, {0, 0, LONG_MAX, LONG_MIN}};
+        outputs[t] = empty;
+    }
+
+    for (size_t vector_start = start; vector_start < end; vector_start += VECTOR_SIZE)
+    {
+        size_t vector_end = vector_start + VECTOR_SIZE < end ? vector_start + VECTOR_SIZE : end;
+        for (size_t n = 0; n < run->num_nodes; n++)
+            evaluate_node(run, n, vectors, counts, vector_start, vector_end);
+        for (size_t t = 0; t < run->num_targets; t++)
+        {
+            size_t n = run->target_index[t];
+            PipelineNode *target = run->nodes[n];
+            if (target->type == AGGREGATE_NODE)
+            {
+                size_t in0 = run->input_index[n][0];
+                AggregatePartial *partial = &outputs[t].partial;
+                for (size_t i = 0; i < counts[in0]; i++)
+                {
+                    long value = vector_value(vectors[in0], target->data_type, i);
+                    partial->sum += value;
+                    partial->min = value < partial->min ? value : partial->min;
+                    partial->max = value > partial->max ? value : partial->max;
+                }
+                partial->count += counts[in0];
+                continue;
+            }
+            size_t size = element_size(target->data_type);
+            if (outputs[t].count + counts[n] > outputs[t].capacity)
+            {
+                outputs[t].capacity = outputs[t].capacity ? 2 * outputs[t].capacity : VECTOR_SIZE;
+                if (outputs[t].capacity < outputs[t].count + counts[n])
+                    outputs[t].capacity = outputs[t].count + counts[n];
+                outputs[t].data = realloc(outputs[t].data, outputs[t].capacity * size);
+            }
+            memcpy((char *)outputs[t].data + outputs[t].count * size, vectors[n], counts[n] * size);
+            outputs[t].count += counts[n];
+        }
+    }
+
+    for (size_t n = 0; n < run->num_nodes; n++)
+        free(vectors[n]);
+    free(vectors);
+    free(counts);
+}
+
+// a scan on its own is a plain select: use the select kernels, which may emit a bitmap
+static Result *materialize_scan(PipelineNode *scan)
+{
+    Column *column = scan->column;
+    const int *zone_min = column->zone_map ? column->zone_map->min : NULL;
+    const int *zone_max = column->zone_map ? column->zone_map->max : NULL;
+    Result *result = malloc(sizeof(Result));
+    result->data_type = LONG;
+    if (choose_position_format(column, scan->low, scan->high) == BITMAP)
+    {
+        result->format = BITMAP;
+        result->num_rows = scan->column_length;
+        result->payload = malloc(bitmap_words(scan->column_length) * sizeof(uint64_t));
+        result->num_tuples = parallel_select_bitmap(column->data, scan->column_length, zone_min, zone_max, scan->low, scan->high, result->payload);
+    }
+    else
+    {
+        PositionBuffer buffer;
+        position_buffer_init(&buffer, estimate_selectivity(column, scan->low, scan->high) * scan->column_length);
+        result->format = MATERIALIZED;
+        result->num_tuples = parallel_select_range(column->data, scan->column_length, zone_min, zone_max, scan->low, scan->high, &buffer);
+        result->payload = position_buffer_finish(&buffer);
+    }
+    return result;
+}
+
+// combines the morsel partials with the result types execute_aggregate uses for the input type
+static Result *aggregate_result(PipelineNode *target, MorselOutput *outputs, size_t morsels, size_t num_targets, size_t t)
+{
+    // partials are long, so arithmetic nodes can exceed the INT sentinels execute_aggregate reports for empty input
+    AggregatePartial total = {0, 0, LONG_MAX, LONG_MIN};
+    for (size_t m = 0; m < morsels; m++)
+    {
+        AggregatePartial *partial = &outputs[m * num_targets + t].partial;
+        total.sum += partial->sum;
+        total.count += partial->count;
+        total.min = partial->min < total.min ? partial->min : total.min;
+        total.max = partial->max > total.max ? partial->max : total.max;
+    }
+    if (total.count == 0)
+    {
+        total.min = __INT_MAX__;
+        total.max = -__INT_MAX__ - 1;
+    }
+    Result *result = malloc(sizeof(Result));
+    result->format = MATERIALIZED;
+    result->num_tuples = 1;
+    if (target->aggregate_type == AVG)
+    {
+        double *result_data = malloc(1 * sizeof(double));
+        if (total.count == 0)
+            *result_data = 0;
+        else if (target->data_type == INT)
+            *result_data = total.sum * 1.0 / total.count;
+        else
+            *result_data = total.sum * 1.0 / (1000 * total.count) * 1000;
+        result->data_type = DOUBLE;
+        result->payload = result_data;
+    }
+    else if (target->aggregate_type == SUM)
+    {
+        long *result_data = malloc(1 * sizeof(long));
+        *result_data = total.sum;
+        result->data_type = LONG;
+        result->payload = result_data;
+    }
+    else if (target->data_type == INT)
+    {
+        int *result_data = malloc(1 * sizeof(int));
+        *result_data = target->aggregate_type == MIN ? total.min : total.max;
+        result->data_type = INT;
+        result->payload = result_data;
+    }
+    else
+    {
+        long *result_data = malloc(1 * sizeof(long));
+        *result_data = target->aggregate_type == MIN ? total.min : total.max;
+        result->data_type = LONG;
+        result->payload = result_data;
+    }
+    return result;
+}
+
+void pipeline_run(PipelineNode **targets, size_t num_targets, Result **results)
+{
+    PipelineRun run = {NULL, 0, NULL, malloc(num_targets * sizeof(size_t)), 0, NULL};
+    size_t *result_target = malloc(num_targets * sizeof(size_t));
+    for (size_t i = 0; i < num_targets; i++)
+    {
+        if (targets[i]->type == SCAN_NODE)
+        {
+            results[i] = materialize_scan(targets[i]);
+            continue;
+        }
+        result_target[i] = run.num_targets;
+        run.target_index[run.num_targets++] = collect_node(&run, targets[i]);
+    }
+    if (run.num_targets > 0)
+    {
+        size_t column_length = targets[0]->source->column_length;
+        size_t morsels = num_morsels(column_length, MORSEL_SIZE);
+        run.outputs = malloc(morsels * run.num_targets * sizeof(MorselOutput));
+        run_morsels(column_length, MORSEL_SIZE, &pipeline_morsel, &run);
+        for (size_t i = 0; i < num_targets; i++)
+        {
+            if (targets[i]->type == SCAN_NODE)
+                continue;
+            size_t t = result_target[i];
+            if (targets[i]->type == AGGREGATE_NODE)
+            {
+                results[i] = aggregate_result(targets[i], run.outputs, morsels, run.num_targets, t);
+                continue;
+            }
+            // concatenate the morsel outputs in row order
+            size_t size = element_size(targets[i]->data_type);
+            size_t total = 0;
+            for (size_t m = 0; m < morsels; m++)
+                total += run.outputs[m * run.num_targets + t].count;
+            Result *result = malloc(sizeof(Result));
+            result->format = MATERIALIZED;
+            result->data_type = targets[i]->data_type;
+            result->num_tuples = total;
+            result->payload = malloc(total * size);
+            size_t offset = 0;
+            for (size_t m = 0; m < morsels; m++)
+            {
+                MorselOutput *output = &run.outputs[m * run.num_targets + t];
+                memcpy((char *)result->payload + offset * size, output->data, output->count * size);
+                offset += output->count;
+            }
+            results[i] = result;
+        }
+        for (size_t m = 0; m < morsels * run.num_targets; m++)
+            free(run.outputs[m].data);
+        free(run.outputs);
+    }
+    free(run.nodes);
+    free(run.input_index);
+    free(run.target_index);
+    free(result_target);
+}
@@ -0,0 +1,224 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <immintrin.h>
+
+#include "positions.h"
+#include "morsel.h"
+
+typedef size_t (*intersect_fn)(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out);
+
+// for a 4-lane match mask, the dword indices moving the matching 64-bit lanes to the front
+static int32_t compress64[16][8] __attribute__((aligned(32)));
+
+static size_t intersect_merge_scalar(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out)
+{
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb)
+    {
+        size_t x = a[i];
+        size_t y = b[j];
+        out[k] = x;
+        k += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return k;
+}
+
+/*
+ * Compares 4 positions of a with all 4 rotations of 4 positions of b, packs the matches
+ * and advances the block with the smaller maximum (both on a tie). The rest of the lists
+ * goes through the scalar merge.
+ */
+__attribute__((target("avx2"))) static size_t intersect_merge_avx2(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out)
+{
+    const __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+    size_t i = 0, j = 0, k = 0;
+    while (i + 4 <= na && j + 4 <= nb)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + j));
+        __m256i match = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi64(va, vb), _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39))),
+            _mm256_or_si256(_mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4E)), _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93))));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(match));
+        __m256i packed = _mm256_permutevar8x32_epi32(va, _mm256_load_si256((const __m256i *)compress64[mask]));
+        int count = __builtin_popcount(mask);
+        _mm256_maskstore_epi64((long long *)(out + k), _mm256_cmpgt_epi64(_mm256_set1_epi64x(count), lanes), packed);
+        k += count;
+        size_t a_max = a[i + 3];
+        size_t b_max = b[j + 3];
+        i += a_max <= b_max ? 4 : 0;
+        j += b_max <= a_max ? 4 : 0;
+    }
+    return k + intersect_merge_scalar(a + i, na - i, b + j, nb - j, out + k);
+}
+
+static intersect_fn intersect_merge_impl = intersect_merge_scalar;
+static pthread_once_t positions_once = PTHREAD_ONCE_INIT;
+
+static void positions_init(void)
+{
+    for (int mask = 0; mask < 16; mask++)
+    {
+        int k = 0;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                compress64[mask][2 * k] = 2 * lane;
+                compress64[mask][2 * k + 1] = 2 * lane + 1;
+                k++;
+            }
+        }
+        for (; k < 4; k++)
+        {
+            compress64[mask][2 * k] = 0;
+            compress64[mask][2 * k + 1] = 1;
+        }
+    }
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        intersect_merge_impl = intersect_merge_avx2;
+}
+
+size_t intersect_positions_merge(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out)
+{
+    pthread_once(&positions_once, positions_init);
+    return intersect_merge_impl(a, na, b, nb, out);
+}
+
+// first index in [from, n) with positions[index] >= target
+static size_t lower_bound(const size_t *positions, size_t from, size_t n, size_t target)
+{
+    size_t low = from, high = n;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (positions[mid] < target)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+size_t intersect_positions_gallop(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out)
+{
+    size_t k = 0;
+    size_t from = 0;
+    for (size_t i = 0; i < na && from < nb; i++)
+    {
+        // double the step until it passes a[i], then binary search the last step
+        size_t step = 1;
+        while (from + step < nb && b[from + step] < a[i])
+            step *= 2;
+        from = lower_bound(b, from + step / 2, from + step < nb ? from + step + 1 : nb, a[i]);
+        if (from < nb && b[from] == a[i])
+            out[k++] = a[i];
+    }
+    return k;
+}
+
+size_t intersect_positions(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out)
+{
+    if (na * GALLOP_RATIO < nb)
+        return intersect_positions_gallop(a, na, b, nb, out);
+    if (nb * GALLOP_RATIO < na)
+        return intersect_positions_gallop(b, nb, a, na, out);
+    return intersect_positions_merge(a, na, b, nb, out);
+}
+
+size_t union_positions(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out)
+{
+    size_t i = 0, j = 0, k = 0;
+    while (i < na && j < nb)
+    {
+        size_t x = a[i];
+        size_t y = b[j];
+        out[k++] = x < y ? x : y;
+        i += x <= y;
+        j += y <= x;
+    }
+    memcpy(out + k, a + i, (na - i) * sizeof(size_t));
+    k += na - i;
+    memcpy(out + k, b + j, (nb - j) * sizeof(size_t));
+    return k + nb - j;
+}
+
+typedef struct MorselMerge
+{
+    const size_t *a;
+    size_t na;
+    const size_t *b;
+    size_t nb;
+    size_t *out;
+    bool disjunctive;
+    size_t *offsets; // where each morsel's output starts in out
+    size_t *counts;
+} MorselMerge;
+
+static void merge_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MorselMerge *merge = (MorselMerge *)arg;
+    // the slice of b holding the values between this morsel's first value and the next morsel's
+    size_t b_start = start > 0 ? lower_bound(merge->b, 0, merge->nb, merge->a[start]) : 0;
+    size_t b_end = end < merge->na ? lower_bound(merge->b, b_start, merge->nb, merge->a[end]) : merge->nb;
+    if (merge->disjunctive)
+    {
+        merge->offsets[morsel] = start + b_start;
+        merge->counts[morsel] = union_positions(merge->a + start, end - start, merge->b + b_start, b_end - b_start, merge->out + start + b_start);
+    }
+    else
+    {
+        merge->offsets[morsel] = start;
+        merge->counts[morsel] = intersect_positions(merge->a + start, end - start, merge->b + b_start, b_end - b_start, merge->out + start);
+    }
+}
+
+static size_t parallel_merge(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out, bool disjunctive)
+{
+    size_t morsels = num_morsels(na, MORSEL_SIZE);
+    MorselMerge merge = {a, na, b, nb, out, disjunctive, malloc(morsels * sizeof(size_t)), malloc(morsels * sizeof(size_t))};
+    run_morsels(na, MORSEL_SIZE, &merge_morsel, &merge);
+    // every morsel's output starts at or after the end of the previous ones, so moving in order is safe
+    size_t index = 0;
+    for (size_t m = 0; m < morsels; m++)
+    {
+        memmove(out + index, out + merge.offsets[m], merge.counts[m] * sizeof(size_t));
+        index += merge.counts[m];
+    }
+    free(merge.offsets);
+    free(merge.counts);
+    return index;
+}
+
+size_t parallel_intersect_positions(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out)
+{
+    // morsels are cut from the smaller list, so every output slice fits in its morsel's part of out
+    if (na > nb)
+        return parallel_merge(b, nb, a, na, out, false);
+    return parallel_merge(a, na, b, nb, out, false);
+}
+
+size_t parallel_union_positions(const size_t *a, size_t na, const size_t *b, size_t nb, size_t *out)
+{
+    if (na == 0)
+    {
+        memcpy(out, b, nb * sizeof(size_t));
+        return nb;
+    }
+    return parallel_merge(a, na, b, nb, out, true);
+}
+
+bool positions_sorted(const size_t *positions, size_t num_positions)
+{
+    for (size_t i = 1; i < num_positions; i++)
+    {
+        if (positions[i] <= positions[i - 1])
+            return false;
+    }
+    return true;
+}
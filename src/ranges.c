@@ -0,0 +1,67 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "ranges.h"
+
+size_t ranges_to_positions(const PositionRange *ranges, size_t num_ranges, size_t *out)
+{
+    size_t k = 0;
+    for (size_t r = 0; r < num_ranges; r++)
+    {
+        for (size_t i = ranges[r].start; i < ranges[r].end; i++)
+        {
+            out[k++] = i;
+        }
+    }
+    return k;
+}
+
+size_t ranges_fetch(const PositionRange *ranges, size_t num_ranges, const int *data, int *out)
+{
+    size_t k = 0;
+    for (size_t r = 0; r < num_ranges; r++)
+    {
+        size_t length = ranges[r].end - ranges[r].start;
+        memcpy(out + k, data + ranges[r].start, length * sizeof(int));
+        k += length;
+    }
+    return k;
+}
+
+size_t ranges_sum(const PositionRange *ranges, size_t num_ranges)
+{
+    size_t sum = 0;
+    for (size_t r = 0; r < num_ranges; r++)
+    {
+        // arithmetic series start + ... + (end - 1)
+        sum += (ranges[r].start + ranges[r].end - 1) * (ranges[r].end - ranges[r].start) / 2;
+    }
+    return sum;
+}
+
+size_t positions_to_ranges(const size_t *positions, size_t num_positions, size_t max_ranges, PositionRange **ranges)
+{
+    size_t num_ranges = num_positions > 0;
+    for (size_t i = 1; i < num_positions && num_ranges <= max_ranges; i++)
+    {
+        num_ranges += positions[i] != positions[i - 1] + 1;
+    }
+    if (num_ranges == 0 || num_ranges > max_ranges)
+    {
+        return 0;
+    }
+    PositionRange *encoded = malloc(num_ranges * sizeof(PositionRange));
+    size_t r = 0;
+    encoded[0].start = positions[0];
+    for (size_t i = 1; i < num_positions; i++)
+    {
+        if (positions[i] != positions[i - 1] + 1)
+        {
+            encoded[r++].end = positions[i - 1] + 1;
+            encoded[r].start = positions[i];
+        }
+    }
+    encoded[r].end = positions[num_positions - 1] + 1;
+    *ranges = encoded;
+    return num_ranges;
+}
@@ -0,0 +1,332 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <immintrin.h>
+
+#include "reduce.h"
+#include "morsel.h"
+
+static pthread_once_t reduce_once = PTHREAD_ONCE_INIT;
+static long (*sum_int_impl)(const int *, size_t, size_t) = sum_int_scalar;
+static long (*sum_long_impl)(const long *, size_t, size_t) = sum_long_scalar;
+static double (*sum_float_impl)(const float *, size_t, size_t) = sum_float_scalar;
+static double (*sum_double_impl)(const double *, size_t, size_t) = sum_double_scalar;
+static void (*minmax_int_impl)(const int *, size_t, size_t, int *, int *) = minmax_int_scalar;
+static void (*minmax_long_impl)(const long *, size_t, size_t, long *, long *) = minmax_long_scalar;
+static void (*minmax_float_impl)(const float *, size_t, size_t, float *, float *) = minmax_float_scalar;
+static void (*minmax_double_impl)(const double *, size_t, size_t, double *, double *) = minmax_double_scalar;
+
+static void reduce_init(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        sum_int_impl = sum_int_avx2;
+        sum_long_impl = sum_long_avx2;
+        sum_float_impl = sum_float_avx2;
+        sum_double_impl = sum_double_avx2;
+        minmax_int_impl = minmax_int_avx2;
+        minmax_long_impl = minmax_long_avx2;
+        minmax_float_impl = minmax_float_avx2;
+        minmax_double_impl = minmax_double_avx2;
+    }
+}
+
+#define REDUCE_SCALAR(TYPE, SUM)                                                                    \
+    SUM sum_##TYPE##_scalar(const TYPE *data, size_t start, size_t end)                            \
+    {                                                                                               \
+        /* independent accumulators break the dependency chain through a single sum */              \
+        SUM s0 = 0, s1 = 0, s2 = 0, s3 = 0;                                                         \
+        size_t i = start;                                                                           \
+        for (; i + 4 <= end; i += 4)                                                                \
+        {                                                                                           \
+            s0 += data[i];                                                                          \
+            s1 += data[i + 1];                                                                      \
+            s2 += data[i + 2];                                                                      \
+            s3 += data[i + 3];                                                                      \
+        }                                                                                           \
+        for (; i < end; i++)                                                                        \
+            s0 += data[i];                                                                          \
+        return (s0 + s1) + (s2 + s3);                                                               \
+    }                                                                                               \
+                                                                                                    \
+    void minmax_##TYPE##_scalar(const TYPE *data, size_t start, size_t end, TYPE *min, TYPE *max)  \
+    {                                                                                               \
+        TYPE lo = *min, hi = *max;                                                                  \
+        for (size_t i = start; i < end; i++)                                                        \
+        {                                                                                           \
+            lo = data[i] < lo ? data[i] : lo;                                                       \
+            hi = data[i] > hi ? data[i] : hi;                                                       \
+        }                                                                                           \
+        *min = lo;                                                                                  \
+        *max = hi;                                                                                  \
+    }
+
+REDUCE_SCALAR(int, long)
+REDUCE_SCALAR(long, long)
+REDUCE_SCALAR(float, double)
+REDUCE_SCALAR(double, double)
+
+// adds the four 64-bit lanes of v
+__attribute__((target("avx2"))) static long hsum_epi64(__m256i v)
+{
+    __m128i pair = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(pair) + _mm_extract_epi64(pair, 1);
+}
+
+__attribute__((target("avx2"))) static double hsum_pd(__m256d v)
+{
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+__attribute__((target("avx2"))) long sum_int_avx2(const int *data, size_t start, size_t end)
+{
+    // every int is widened to 64 bits before it is added, so the sum cannot overflow a lane
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+    size_t i = start;
+    for (; i + 16 <= end; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(data + i + 8));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(a)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(a, 1)));
+        acc2 = _mm256_add_epi64(acc2, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(b)));
+        acc3 = _mm256_add_epi64(acc3, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(b, 1)));
+    }
+    __m256i acc = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    return hsum_epi64(acc) + sum_int_scalar(data, i, end);
+}
+
+__attribute__((target("avx2"))) long sum_long_avx2(const long *data, size_t start, size_t end)
+{
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+    size_t i = start;
+    for (; i + 16 <= end; i += 16)
+    {
+        acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256((const __m256i *)(data + i)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256((const __m256i *)(data + i + 4)));
+        acc2 = _mm256_add_epi64(acc2, _mm256_loadu_si256((const __m256i *)(data + i + 8)));
+        acc3 = _mm256_add_epi64(acc3, _mm256_loadu_si256((const __m256i *)(data + i + 12)));
+    }
+    __m256i acc = _mm256_add_epi64(_mm256_add_epi64(acc0, acc1), _mm256_add_epi64(acc2, acc3));
+    return hsum_epi64(acc) + sum_long_scalar(data, i, end);
+}
+
+__attribute__((target("avx2"))) double sum_float_avx2(const float *data, size_t start, size_t end)
+{
+    // floats are widened to double, the same precision the scalar kernel sums in
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+    size_t i = start;
+    for (; i + 16 <= end; i += 16)
+    {
+        __m256 a = _mm256_loadu_ps(data + i);
+        __m256 b = _mm256_loadu_ps(data + i + 8);
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm256_castps256_ps128(a)));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1)));
+        acc2 = _mm256_add_pd(acc2, _mm256_cvtps_pd(_mm256_castps256_ps128(b)));
+        acc3 = _mm256_add_pd(acc3, _mm256_cvtps_pd(_mm256_extractf128_ps(b, 1)));
+    }
+    __m256d acc = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    return hsum_pd(acc) + sum_float_scalar(data, i, end);
+}
+
+__attribute__((target("avx2"))) double sum_double_avx2(const double *data, size_t start, size_t end)
+{
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd(), acc3 = _mm256_setzero_pd();
+    size_t i = start;
+    for (; i + 16 <= end; i += 16)
+    {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(data + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(data + i + 4));
+        acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(data + i + 8));
+        acc3 = _mm256_add_pd(acc3, _mm256_loadu_pd(data + i + 12));
+    }
+    __m256d acc = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    return hsum_pd(acc) + sum_double_scalar(data, i, end);
+}
+
+__attribute__((target("avx2"))) void minmax_int_avx2(const int *data, size_t start, size_t end, int *min, int *max)
+{
+    __m256i lo0 = _mm256_set1_epi32(*min), lo1 = lo0;
+    __m256i hi0 = _mm256_set1_epi32(*max), hi1 = hi0;
+    size_t i = start;
+    for (; i + 16 <= end; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(data + i + 8));
+        lo0 = _mm256_min_epi32(lo0, a);
+        lo1 = _mm256_min_epi32(lo1, b);
+        hi0 = _mm256_max_epi32(hi0, a);
+        hi1 = _mm256_max_epi32(hi1, b);
+    }
+    int lanes_lo[8], lanes_hi[8];
+    _mm256_storeu_si256((__m256i *)lanes_lo, _mm256_min_epi32(lo0, lo1));
+    _mm256_storeu_si256((__m256i *)lanes_hi, _mm256_max_epi32(hi0, hi1));
+    for (int k = 0; k < 8; k++)
+    {
+        *min = lanes_lo[k] < *min ? lanes_lo[k] : *min;
+        *max = lanes_hi[k] > *max ? lanes_hi[k] : *max;
+    }
+    minmax_int_scalar(data, i, end, min, max);
+}
+
+__attribute__((target("avx2"))) void minmax_long_avx2(const long *data, size_t start, size_t end, long *min, long *max)
+{
+    // no 64-bit min/max before AVX-512: compare and blend
+    __m256i lo0 = _mm256_set1_epi64x(*min), lo1 = lo0;
+    __m256i hi0 = _mm256_set1_epi64x(*max), hi1 = hi0;
+    size_t i = start;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(data + i + 4));
+        lo0 = _mm256_blendv_epi8(lo0, a, _mm256_cmpgt_epi64(lo0, a));
+        lo1 = _mm256_blendv_epi8(lo1, b, _mm256_cmpgt_epi64(lo1, b));
+        hi0 = _mm256_blendv_epi8(hi0, a, _mm256_cmpgt_epi64(a, hi0));
+        hi1 = _mm256_blendv_epi8(hi1, b, _mm256_cmpgt_epi64(b, hi1));
+    }
+    long lanes_lo[8], lanes_hi[8];
+    _mm256_storeu_si256((__m256i *)lanes_lo, lo0);
+    _mm256_storeu_si256((__m256i *)(lanes_lo + 4), lo1);
+    _mm256_storeu_si256((__m256i *)lanes_hi, hi0);
+    _mm256_storeu_si256((__m256i *)(lanes_hi + 4), hi1);
+    // the lanes hold the seeds as well as data, so each side folds into its own bound only
+    for (int k = 0; k < 8; k++)
+    {
+        *min = lanes_lo[k] < *min ? lanes_lo[k] : *min;
+        *max = lanes_hi[k] > *max ? lanes_hi[k] : *max;
+    }
+    minmax_long_scalar(data, i, end, min, max);
+}
+
+__attribute__((target("avx2"))) void minmax_float_avx2(const float *data, size_t start, size_t end, float *min, float *max)
+{
+    __m256 lo0 = _mm256_set1_ps(*min), lo1 = lo0;
+    __m256 hi0 = _mm256_set1_ps(*max), hi1 = hi0;
+    size_t i = start;
+    for (; i + 16 <= end; i += 16)
+    {
+        __m256 a = _mm256_loadu_ps(data + i);
+        __m256 b = _mm256_loadu_ps(data + i + 8);
+        lo0 = _mm256_min_ps(lo0, a);
+        lo1 = _mm256_min_ps(lo1, b);
+        hi0 = _mm256_max_ps(hi0, a);
+        hi1 = _mm256_max_ps(hi1, b);
+    }
+    float lanes_lo[8], lanes_hi[8];
+    _mm256_storeu_ps(lanes_lo, _mm256_min_ps(lo0, lo1));
+    _mm256_storeu_ps(lanes_hi, _mm256_max_ps(hi0, hi1));
+    for (int k = 0; k < 8; k++)
+    {
+        *min = lanes_lo[k] < *min ? lanes_lo[k] : *min;
+        *max = lanes_hi[k] > *max ? lanes_hi[k] : *max;
+    }
+    minmax_float_scalar(data, i, end, min, max);
+}
+
+__attribute__((target("avx2"))) void minmax_double_avx2(const double *data, size_t start, size_t end, double *min, double *max)
+{
+    __m256d lo0 = _mm256_set1_pd(*min), lo1 = lo0;
+    __m256d hi0 = _mm256_set1_pd(*max), hi1 = hi0;
+    size_t i = start;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256d a = _mm256_loadu_pd(data + i);
+        __m256d b = _mm256_loadu_pd(data + i + 4);
+        lo0 = _mm256_min_pd(lo0, a);
+        lo1 = _mm256_min_pd(lo1, b);
+        hi0 = _mm256_max_pd(hi0, a);
+        hi1 = _mm256_max_pd(hi1, b);
+    }
+    double lanes_lo[4], lanes_hi[4];
+    _mm256_storeu_pd(lanes_lo, _mm256_min_pd(lo0, lo1));
+    _mm256_storeu_pd(lanes_hi, _mm256_max_pd(hi0, hi1));
+    for (int k = 0; k < 4; k++)
+    {
+        *min = lanes_lo[k] < *min ? lanes_lo[k] : *min;
+        *max = lanes_hi[k] > *max ? lanes_hi[k] : *max;
+    }
+    minmax_double_scalar(data, i, end, min, max);
+}
+
+typedef struct MorselReduce
+{
+    const void *data;
+    void *partials; // per-morsel sums, or minimums next to maxs
+    void *maxs;
+} MorselReduce;
+
+#define REDUCE(TYPE, SUM)                                                                                  \
+    SUM sum_##TYPE(const TYPE *data, size_t start, size_t end)                                             \
+    {                                                                                                      \
+        pthread_once(&reduce_once, reduce_init);                                                           \
+        return sum_##TYPE##_impl(data, start, end);                                                        \
+    }                                                                                                      \
+                                                                                                           \
+    void minmax_##TYPE(const TYPE *data, size_t start, size_t end, TYPE *min, TYPE *max)                   \
+    {                                                                                                      \
+        pthread_once(&reduce_once, reduce_init);                                                           \
+        minmax_##TYPE##_impl(data, start, end, min, max);                                                  \
+    }                                                                                                      \
+                                                                                                           \
+    static void sum_##TYPE##_morsel(void *arg, size_t morsel, size_t start, size_t end)                    \
+    {                                                                                                      \
+        MorselReduce *reduce = (MorselReduce *)arg;                                                        \
+        ((SUM *)reduce->partials)[morsel] = sum_##TYPE(reduce->data, start, end);                          \
+    }                                                                                                      \
+                                                                                                           \
+    SUM parallel_sum_##TYPE(const TYPE *data, size_t length)                                               \
+    {                                                                                                      \
+        if (length < PARALLEL_REDUCE_THRESHOLD)                                                            \
+            return sum_##TYPE(data, 0, length);                                                            \
+        size_t morsels = num_morsels(length, MORSEL_SIZE);                                                 \
+        MorselReduce reduce = {data, malloc(morsels * sizeof(SUM)), NULL};                                 \
+        run_morsels(length, MORSEL_SIZE, &sum_##TYPE##_morsel, &reduce);                                   \
+        SUM total = 0;                                                                                     \
+        for (size_t m = 0; m < morsels; m++)                                                               \
+            total += ((SUM *)reduce.partials)[m];                                                          \
+        free(reduce.partials);                                                                             \
+        return total;                                                                                      \
+    }                                                                                                      \
+                                                                                                           \
+    static void minmax_##TYPE##_morsel(void *arg, size_t morsel, size_t start, size_t end)                 \
+    {                                                                                                      \
+        MorselReduce *reduce = (MorselReduce *)arg;                                                        \
+        const TYPE *data = reduce->data;                                                                   \
+        TYPE *mins = reduce->partials;                                                                     \
+        TYPE *maxs = reduce->maxs;                                                                         \
+        /* morsels are never empty, so the first row seeds both bounds */                                  \
+        mins[morsel] = data[start];                                                                        \
+        maxs[morsel] = data[start];                                                                        \
+        minmax_##TYPE(data, start, end, &mins[morsel], &maxs[morsel]);                                     \
+    }                                                                                                      \
+                                                                                                           \
+    void parallel_minmax_##TYPE(const TYPE *data, size_t length, TYPE *min, TYPE *max)                     \
+    {                                                                                                      \
+        if (length < PARALLEL_REDUCE_THRESHOLD)                                                            \
+        {                                                                                                  \
+            minmax_##TYPE(data, 0, length, min, max);                                                      \
+            return;                                                                                        \
+        }                                                                                                  \
+        size_t morsels = num_morsels(length, MORSEL_SIZE);                                                 \
+        MorselReduce reduce = {data, malloc(morsels * sizeof(TYPE)), malloc(morsels * sizeof(TYPE))};      \
+        run_morsels(length, MORSEL_SIZE, &minmax_##TYPE##_morsel, &reduce);                                \
+        TYPE *mins = reduce.partials;                                                                      \
+        TYPE *maxs = reduce.maxs;                                                                          \
+        for (size_t m = 0; m < morsels; m++)                                                               \
+        {                                                                                                  \
+            *min = mins[m] < *min ? mins[m] : *min;                                                        \
+            *max = maxs[m] > *max ? maxs[m] : *max;                                                        \
+        }                                                                                                  \
+        free(reduce.partials);                                                                             \
+        free(reduce.maxs);                                                                                 \
+    }
+
+REDUCE(int, long)
+REDUCE(long, long)
+REDUCE(float, double)
+REDUCE(double, double)
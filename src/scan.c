@@ -0,0 +1,487 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <immintrin.h>
+
+#include "scan.h"
+#include "morsel.h"
+#include "bitmap.h"
+
+// compress tables: for a compare mask, the lane indices of the matching lanes packed to the front
+static int32_t avx2_compress[256][8] __attribute__((aligned(32)));
+static uint8_t sse4_compress[16][16] __attribute__((aligned(16)));
+// for a 4-lane compare mask, the dword indices moving the matching 64-bit lanes to the front
+static int32_t avx2_compress64[16][8] __attribute__((aligned(32)));
+
+static select_range_fn select_range_impl = select_range_scalar;
+static select_bitmap_fn select_bitmap_impl = select_bitmap_scalar;
+static filter_positions_int_fn filter_positions_int_impl = filter_positions_int_scalar;
+static filter_positions_long_fn filter_positions_long_impl = filter_positions_long_scalar;
+static filter_positions_float_fn filter_positions_float_impl = filter_positions_float_scalar;
+static filter_positions_double_fn filter_positions_double_impl = filter_positions_double_scalar;
+static pthread_once_t scan_once = PTHREAD_ONCE_INIT;
+
+static void build_compress_tables(void)
+{
+    for (int mask = 0; mask < 256; mask++)
+    {
+        int k = 0;
+        for (int lane = 0; lane < 8; lane++)
+        {
+            if (mask & (1 << lane))
+                avx2_compress[mask][k++] = lane;
+        }
+        // unused lanes are written past the end of the output and overwritten later
+        while (k < 8)
+            avx2_compress[mask][k++] = 0;
+    }
+    for (int mask = 0; mask < 16; mask++)
+    {
+        int k = 0;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                avx2_compress64[mask][2 * k] = 2 * lane;
+                avx2_compress64[mask][2 * k + 1] = 2 * lane + 1;
+                k++;
+            }
+        }
+        while (k < 4)
+        {
+            avx2_compress64[mask][2 * k] = 0;
+            avx2_compress64[mask][2 * k + 1] = 1;
+            k++;
+        }
+    }
+    for (int mask = 0; mask < 16; mask++)
+    {
+        int k = 0;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                for (int b = 0; b < 4; b++)
+                    sse4_compress[mask][4 * k + b] = 4 * lane + b;
+                k++;
+            }
+        }
+        while (k < 4)
+        {
+            for (int b = 0; b < 4; b++)
+                sse4_compress[mask][4 * k + b] = 0x80;
+            k++;
+        }
+    }
+}
+
+static void scan_init(void)
+{
+    build_compress_tables();
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        select_range_impl = select_range_avx2;
+        select_bitmap_impl = select_bitmap_avx2;
+        filter_positions_int_impl = filter_positions_int_avx2;
+        filter_positions_long_impl = filter_positions_long_avx2;
+        filter_positions_float_impl = filter_positions_float_avx2;
+        filter_positions_double_impl = filter_positions_double_avx2;
+    }
+    else if (__builtin_cpu_supports("sse4.1"))
+    {
+        select_range_impl = select_range_sse4;
+        select_bitmap_impl = select_bitmap_sse4;
+    }
+    else
+    {
+        select_range_impl = select_range_scalar;
+        select_bitmap_impl = select_bitmap_scalar;
+    }
+}
+
+size_t select_range_scalar(const int *data, size_t start, size_t end, int low, int high, size_t *out)
+{
+    size_t k = 0;
+    for (size_t i = start; i < end; i++)
+    {
+        // always write, only advance on a match: no data-dependent branch
+        out[k] = i;
+        k += (data[i] >= low) & (data[i] <= high);
+    }
+    return k;
+}
+
+__attribute__((target("sse4.1"))) size_t select_range_sse4(const int *data, size_t start, size_t end, int low, int high, size_t *out)
+{
+    pthread_once(&scan_once, scan_init);
+    const __m128i low_v = _mm_set1_epi32(low);
+    const __m128i high_v = _mm_set1_epi32(high);
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    size_t k = 0;
+    size_t i = start;
+    // k never exceeds i - start, so the full 4-wide store stays inside out
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128i values = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(low_v, values), _mm_cmpgt_epi32(values, high_v));
+        int mask = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+        __m128i packed = _mm_shuffle_epi8(lanes, _mm_load_si128((const __m128i *)sse4_compress[mask]));
+        __m128i base = _mm_set1_epi64x((long long)i);
+        _mm_storeu_si128((__m128i *)(out + k), _mm_add_epi64(_mm_cvtepu32_epi64(packed), base));
+        _mm_storeu_si128((__m128i *)(out + k + 2), _mm_add_epi64(_mm_cvtepu32_epi64(_mm_srli_si128(packed, 8)), base));
+        k += __builtin_popcount(mask);
+    }
+    return k + select_range_scalar(data, i, end, low, high, out + k);
+}
+
+__attribute__((target("avx2"))) size_t select_range_avx2(const int *data, size_t start, size_t end, int low, int high, size_t *out)
+{
+    pthread_once(&scan_once, scan_init);
+    const __m256i low_v = _mm256_set1_epi32(low);
+    const __m256i high_v = _mm256_set1_epi32(high);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t k = 0;
+    size_t i = start;
+    // k never exceeds i - start, so the full 8-wide store stays inside out
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256i values = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low_v, values), _mm256_cmpgt_epi32(values, high_v));
+        int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+        __m256i packed = _mm256_permutevar8x32_epi32(lanes, _mm256_load_si256((const __m256i *)avx2_compress[mask]));
+        __m256i base = _mm256_set1_epi64x((long long)i);
+        _mm256_storeu_si256((__m256i *)(out + k), _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(packed)), base));
+        _mm256_storeu_si256((__m256i *)(out + k + 4), _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_extracti128_si256(packed, 1)), base));
+        k += __builtin_popcount(mask);
+    }
+    return k + select_range_scalar(data, i, end, low, high, out + k);
+}
+
+size_t select_range(const int *data, size_t start, size_t end, int low, int high, size_t *out)
+{
+    pthread_once(&scan_once, scan_init);
+    return select_range_impl(data, start, end, low, high, out);
+}
+
+size_t select_range_zoned(const int *data, size_t start, size_t end, const int *zone_min, const int *zone_max, int low, int high, size_t *out)
+{
+    if (!zone_min || !zone_max)
+        return select_range(data, start, end, low, high, out);
+    size_t k = 0;
+    for (size_t zone_start = start; zone_start < end; zone_start += ZONE_SIZE)
+    {
+        size_t zone = zone_start / ZONE_SIZE;
+        size_t zone_end = zone_start + ZONE_SIZE < end ? zone_start + ZONE_SIZE : end;
+        if (zone_max[zone] < low || zone_min[zone] > high)
+            continue;
+        if (zone_min[zone] >= low && zone_max[zone] <= high)
+        {
+            for (size_t i = zone_start; i < zone_end; i++)
+                out[k++] = i;
+        }
+        else
+        {
+            k += select_range(data, zone_start, zone_end, low, high, out + k);
+        }
+    }
+    return k;
+}
+
+typedef struct MorselSelect
+{
+    const int *data;
+    const int *zone_min;
+    const int *zone_max;
+    int low;
+    int high;
+    MorselPositions outputs;
+} MorselSelect;
+
+static void select_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MorselSelect *select = (MorselSelect *)arg;
+    // scan into a pooled chunk, gathered into the output once every morsel is done
+    size_t *chunk = acquire_chunk();
+    size_t count = select_range_zoned(select->data, start, end, select->zone_min, select->zone_max, select->low, select->high, chunk);
+    morsel_positions_keep(&select->outputs, morsel, chunk, count);
+}
+
+size_t parallel_select_range(const int *data, size_t length, const int *zone_min, const int *zone_max, int low, int high, PositionBuffer *out)
+{
+    if (length == 0)
+        return 0;
+    MorselSelect select = {data, zone_min, zone_max, low, high, {NULL, NULL, 0}};
+    morsel_positions_init(&select.outputs, length);
+    run_morsels(length, MORSEL_SIZE, &select_morsel, &select);
+    return morsel_positions_gather(&select.outputs, out);
+}
+
+size_t select_bitmap_scalar(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits)
+{
+    size_t count = 0;
+    for (size_t w = start; w < end; w += BITMAP_WORD_BITS)
+    {
+        size_t stop = w + BITMAP_WORD_BITS < end ? w + BITMAP_WORD_BITS : end;
+        uint64_t word = 0;
+        for (size_t i = w; i < stop; i++)
+            word |= (uint64_t)((data[i] >= low) & (data[i] <= high)) << (i - w);
+        bits[w / BITMAP_WORD_BITS] = word;
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+__attribute__((target("sse4.1"))) size_t select_bitmap_sse4(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits)
+{
+    const __m128i low_v = _mm_set1_epi32(low);
+    const __m128i high_v = _mm_set1_epi32(high);
+    size_t count = 0;
+    size_t w = start;
+    // 16 compares of 4 lanes fill one word, the partial last word goes through the scalar kernel
+    for (; w + BITMAP_WORD_BITS <= end; w += BITMAP_WORD_BITS)
+    {
+        uint64_t word = 0;
+        for (int j = 0; j < 16; j++)
+        {
+            __m128i values = _mm_loadu_si128((const __m128i *)(data + w + 4 * j));
+            __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(low_v, values), _mm_cmpgt_epi32(values, high_v));
+            word |= (uint64_t)(~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF) << (4 * j);
+        }
+        bits[w / BITMAP_WORD_BITS] = word;
+        count += __builtin_popcountll(word);
+    }
+    return count + select_bitmap_scalar(data, w, end, low, high, bits);
+}
+
+__attribute__((target("avx2"))) size_t select_bitmap_avx2(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits)
+{
+    const __m256i low_v = _mm256_set1_epi32(low);
+    const __m256i high_v = _mm256_set1_epi32(high);
+    size_t count = 0;
+    size_t w = start;
+    // 8 compares of 8 lanes fill one word, the partial last word goes through the scalar kernel
+    for (; w + BITMAP_WORD_BITS <= end; w += BITMAP_WORD_BITS)
+    {
+        uint64_t word = 0;
+        for (int j = 0; j < 8; j++)
+        {
+            __m256i values = _mm256_loadu_si256((const __m256i *)(data + w + 8 * j));
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low_v, values), _mm256_cmpgt_epi32(values, high_v));
+            word |= (uint64_t)(~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF) << (8 * j);
+        }
+        bits[w / BITMAP_WORD_BITS] = word;
+        count += __builtin_popcountll(word);
+    }
+    return count + select_bitmap_scalar(data, w, end, low, high, bits);
+}
+
+size_t select_bitmap(const int *data, size_t start, size_t end, int low, int high, uint64_t *bits)
+{
+    pthread_once(&scan_once, scan_init);
+    return select_bitmap_impl(data, start, end, low, high, bits);
+}
+
+size_t select_bitmap_zoned(const int *data, size_t start, size_t end, const int *zone_min, const int *zone_max, int low, int high, uint64_t *bits)
+{
+    if (!zone_min || !zone_max)
+        return select_bitmap(data, start, end, low, high, bits);
+    size_t count = 0;
+    for (size_t zone_start = start; zone_start < end; zone_start += ZONE_SIZE)
+    {
+        size_t zone = zone_start / ZONE_SIZE;
+        size_t zone_end = zone_start + ZONE_SIZE < end ? zone_start + ZONE_SIZE : end;
+        size_t first_word = zone_start / BITMAP_WORD_BITS;
+        size_t num_words = bitmap_words(zone_end - zone_start);
+        if (zone_max[zone] < low || zone_min[zone] > high)
+        {
+            memset(bits + first_word, 0, num_words * sizeof(uint64_t));
+        }
+        else if (zone_min[zone] >= low && zone_max[zone] <= high)
+        {
+            memset(bits + first_word, 0xFF, num_words * sizeof(uint64_t));
+            if ((zone_end - zone_start) % BITMAP_WORD_BITS)
+                bits[first_word + num_words - 1] = (UINT64_C(1) << ((zone_end - zone_start) % BITMAP_WORD_BITS)) - 1;
+            count += zone_end - zone_start;
+        }
+        else
+        {
+            count += select_bitmap(data, zone_start, zone_end, low, high, bits);
+        }
+    }
+    return count;
+}
+
+typedef struct MorselBitmap
+{
+    const int *data;
+    const int *zone_min;
+    const int *zone_max;
+    int low;
+    int high;
+    uint64_t *bits;
+    size_t *counts;
+} MorselBitmap;
+
+static void select_bitmap_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MorselBitmap *select = (MorselBitmap *)arg;
+    // morsels start on word boundaries, so no two morsels write the same word
+    select->counts[morsel] = select_bitmap_zoned(select->data, start, end, select->zone_min, select->zone_max, select->low, select->high, select->bits);
+}
+
+size_t parallel_select_bitmap(const int *data, size_t length, const int *zone_min, const int *zone_max, int low, int high, uint64_t *bits)
+{
+    if (length == 0)
+        return 0;
+    size_t morsels = num_morsels(length, MORSEL_SIZE);
+    MorselBitmap select = {data, zone_min, zone_max, low, high, bits, malloc(morsels * sizeof(size_t))};
+    run_morsels(length, MORSEL_SIZE, &select_bitmap_morsel, &select);
+    size_t count = 0;
+    for (size_t m = 0; m < morsels; m++)
+        count += select.counts[m];
+    free(select.counts);
+    return count;
+}
+
+// values are compared against low and high the way C compares TYPE with int, in every kernel
+#define FILTER_POSITIONS_SCALAR(TYPE)                                                                                                          \
+    size_t filter_positions_##TYPE##_scalar(const size_t *positions, const TYPE *values, size_t start, size_t end, int low, int high, size_t *out) \
+    {                                                                                                                                          \
+        size_t k = 0;                                                                                                                          \
+        for (size_t i = start; i < end; i++)                                                                                                   \
+        {                                                                                                                                      \
+            out[k] = positions[i];                                                                                                             \
+            k += (values[i] >= low) & (values[i] <= high);                                                                                     \
+        }                                                                                                                                      \
+        return k;                                                                                                                              \
+    }
+
+FILTER_POSITIONS_SCALAR(int)
+FILTER_POSITIONS_SCALAR(long)
+FILTER_POSITIONS_SCALAR(float)
+FILTER_POSITIONS_SCALAR(double)
+
+// packs the positions of the lanes set in the 4-bit mask to out, loading and storing only live lanes
+__attribute__((target("avx2"))) static inline size_t store_positions_avx2(const size_t *positions, int mask, __m256i live, size_t *out)
+{
+    const __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i loaded = _mm256_maskload_epi64((const long long *)positions, live);
+    __m256i packed = _mm256_permutevar8x32_epi32(loaded, _mm256_load_si256((const __m256i *)avx2_compress64[mask]));
+    int count = __builtin_popcount(mask);
+    _mm256_maskstore_epi64((long long *)out, _mm256_cmpgt_epi64(_mm256_set1_epi64x(count), lanes), packed);
+    return count;
+}
+
+/*
+ * 8 values per compare. The last, partial vector is loaded under a lane mask and its dead
+ * lanes never match, and positions are stored under a mask, so the same loop covers the tail.
+ */
+#define FILTER_POSITIONS_AVX2_8(TYPE, VECTOR, LOAD, INSIDE)                                                                                  \
+    __attribute__((target("avx2"))) size_t filter_positions_##TYPE##_avx2(const size_t *positions, const TYPE *values, size_t start, size_t end, \
+                                                                           int low, int high, size_t *out)                                   \
+    {                                                                                                                                        \
+        pthread_once(&scan_once, scan_init);                                                                                                 \
+        const __m256i lanes32 = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);                                                                   \
+        const __m256i lanes64 = _mm256_setr_epi64x(0, 1, 2, 3);                                                                              \
+        const __m256i lanes64_high = _mm256_setr_epi64x(4, 5, 6, 7);                                                                         \
+        size_t k = 0;                                                                                                                        \
+        for (size_t i = start; i < end; i += 8)                                                                                              \
+        {                                                                                                                                    \
+            int remaining = end - i < 8 ? (int)(end - i) : 8;                                                                                \
+            __m256i live = _mm256_cmpgt_epi32(_mm256_set1_epi32(remaining), lanes32);                                                        \
+            VECTOR loaded = LOAD(values + i, live);                                                                                          \
+            int mask = _mm256_movemask_ps(_mm256_and_ps(_mm256_castsi256_ps(live), INSIDE(loaded)));                                         \
+            __m256i remaining64 = _mm256_set1_epi64x(remaining);                                                                             \
+            k += store_positions_avx2(positions + i, mask & 0xF, _mm256_cmpgt_epi64(remaining64, lanes64), out + k);                        \
+            k += store_positions_avx2(positions + i + 4, mask >> 4, _mm256_cmpgt_epi64(remaining64, lanes64_high), out + k);                \
+        }                                                                                                                                    \
+        return k;                                                                                                                            \
+    }
+
+#define INSIDE_INT(v) _mm256_castsi256_ps(_mm256_xor_si256(_mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(low), v), \
+                                                                          _mm256_cmpgt_epi32(v, _mm256_set1_epi32(high))), \
+                                                          _mm256_set1_epi32(-1)))
+#define INSIDE_FLOAT(v) _mm256_and_ps(_mm256_cmp_ps(v, _mm256_set1_ps((float)low), _CMP_GE_OQ), _mm256_cmp_ps(v, _mm256_set1_ps((float)high), _CMP_LE_OQ))
+
+FILTER_POSITIONS_AVX2_8(int, __m256i, _mm256_maskload_epi32, INSIDE_INT)
+FILTER_POSITIONS_AVX2_8(float, __m256, _mm256_maskload_ps, INSIDE_FLOAT)
+
+// 4 values per compare, with the same masked tail
+__attribute__((target("avx2"))) size_t filter_positions_long_avx2(const size_t *positions, const long *values, size_t start, size_t end, int low, int high, size_t *out)
+{
+    pthread_once(&scan_once, scan_init);
+    const __m256i lanes64 = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i low_v = _mm256_set1_epi64x(low);
+    const __m256i high_v = _mm256_set1_epi64x(high);
+    size_t k = 0;
+    for (size_t i = start; i < end; i += 4)
+    {
+        long long remaining = end - i < 4 ? (long long)(end - i) : 4;
+        __m256i live = _mm256_cmpgt_epi64(_mm256_set1_epi64x(remaining), lanes64);
+        __m256i loaded = _mm256_maskload_epi64((const long long *)(values + i), live);
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi64(low_v, loaded), _mm256_cmpgt_epi64(loaded, high_v));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_andnot_si256(outside, live)));
+        k += store_positions_avx2(positions + i, mask, live, out + k);
+    }
+    return k;
+}
+
+// 4 values per compare, with the same masked tail
+__attribute__((target("avx2"))) size_t filter_positions_double_avx2(const size_t *positions, const double *values, size_t start, size_t end, int low, int high, size_t *out)
+{
+    pthread_once(&scan_once, scan_init);
+    const __m256i lanes64 = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256d low_v = _mm256_set1_pd(low);
+    const __m256d high_v = _mm256_set1_pd(high);
+    size_t k = 0;
+    for (size_t i = start; i < end; i += 4)
+    {
+        long long remaining = end - i < 4 ? (long long)(end - i) : 4;
+        __m256i live = _mm256_cmpgt_epi64(_mm256_set1_epi64x(remaining), lanes64);
+        __m256d loaded = _mm256_maskload_pd(values + i, live);
+        __m256d inside = _mm256_and_pd(_mm256_cmp_pd(loaded, low_v, _CMP_GE_OQ), _mm256_cmp_pd(loaded, high_v, _CMP_LE_OQ));
+        int mask = _mm256_movemask_pd(_mm256_and_pd(_mm256_castsi256_pd(live), inside));
+        k += store_positions_avx2(positions + i, mask, live, out + k);
+    }
+    return k;
+}
+
+typedef struct MorselFilter
+{
+    const size_t *positions;
+    const void *values;
+    int low;
+    int high;
+    MorselPositions outputs;
+} MorselFilter;
+
+#define FILTER_POSITIONS(TYPE)                                                                                                          \
+    size_t filter_positions_##TYPE(const size_t *positions, const TYPE *values, size_t start, size_t end, int low, int high, size_t *out) \
+    {                                                                                                                                   \
+        pthread_once(&scan_once, scan_init);                                                                                            \
+        return filter_positions_##TYPE##_impl(positions, values, start, end, low, high, out);                                           \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    static void filter_positions_##TYPE##_morsel(void *arg, size_t morsel, size_t start, size_t end)                                    \
+    {                                                                                                                                   \
+        MorselFilter *filter = (MorselFilter *)arg;                                                                                     \
+        size_t *chunk = acquire_chunk();                                                                                                \
+        size_t count = filter_positions_##TYPE(filter->positions, filter->values, start, end, filter->low, filter->high, chunk);        \
+        morsel_positions_keep(&filter->outputs, morsel, chunk, count);                                                                  \
+    }                                                                                                                                   \
+                                                                                                                                        \
+    size_t parallel_filter_positions_##TYPE(const size_t *positions, const TYPE *values, size_t length, int low, int high,              \
+                                            PositionBuffer *out)                                                                        \
+    {                                                                                                                                   \
+        MorselFilter filter = {positions, values, low, high, {NULL, NULL, 0}};                                                          \
+        morsel_positions_init(&filter.outputs, length);                                                                                 \
+        run_morsels(length, MORSEL_SIZE, &filter_positions_##TYPE##_morsel, &filter);                                                   \
+        return morsel_positions_gather(&filter.outputs, out);                                                                           \
+    }
+
+FILTER_POSITIONS(int)
+FILTER_POSITIONS(long)
+FILTER_POSITIONS(float)
+FILTER_POSITIONS(double)
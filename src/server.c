@@ -30,33 +30,37 @@
 #include "message.h"
 #include "utils.h"
 #include "client_context.h"
-#include "hash_table.h"
+#include "scan.h"
+#include "morsel.h"
+#include "bitmap.h"
+#include "pipeline.h"
+#include "ranges.h"
+#include "positions.h"
+#include "buffer.h"
+#include "reduce.h"
+#include "groupby.h"
+#include "arith.h"
+#include "fetch.h"
+#include "join.h"
 
 #define DEFAULT_QUERY_BUFFER_SIZE 1024
 #define DEFAULT_TABLE_LENGTH 5000000
 #define THREAD 32
 #define QUEUE 256
 #define CACHE_SIZE_THRESHOLD 1000 // for 32 KB L1 cache to store the hash table
-#define NUM_PARTITIONS 7          // = 32KB / 4KB - 1 = 7
+#define SHARED_SCAN_CHUNK ZONE_SIZE // 4096 ints = 16KB, half of a 32 KB L1 cache; one zone per chunk
+#define PARALLEL_SELECT_THRESHOLD (16 * MORSEL_SIZE) // split selects over 1M rows into morsels
+#define FUSED_VECTOR_SIZE 1024    // 1024 positions = 8KB, L1-resident together with the values they gather
 threadpool_t *pool;
 int tasks = 0, done = 0;
-size_t mutex_k = 0;
 pthread_mutex_t lock;
-pthread_mutex_t grace_hash_lock;
 typedef struct thread_args
 {
     DbOperator *query;
     message *send_message;
-    Partition *partitions;
-    Partition *partitionR;
-    Partition *partitionL;
-    size_t *resL;
-    size_t *resR;
-    size_t *posL;
-    size_t *pos;
-    size_t len;
-    int *column;
-    int p_div;
+    DbOperator **queries;
+    Result **results;
+    size_t num_queries;
 } thread_args;
 
 void execute_create(DbOperator *query, message *send_message)
@@ -171,6 +175,8 @@ void execute_insert(DbOperator *query, message *send_message)
         // syncing_column(current_column, insert_table);
         // increase the length of current_column
         current_column->length++;
+        update_zone_map(current_column, insert_table->table_length - 1);
+        update_column_stats(current_column, insert_values[i]);
     }
 
     send_message->status = OK_DONE;
@@ -311,7 +317,9 @@ void execute_load(DbOperator *query, message *send_message)
                 current_table->table_length++;
                 for (size_t column = 0; column < current_table->col_count; column++)
                 {
-                    current_table->columns[column].data[row - 1] = atoi(data);
+                    int value = atoi(data);
+                    current_table->columns[column].data[row - 1] = value;
+                    update_column_stats(&current_table->columns[column], value);
                     data = strtok_r(NULL, ",", &save2);
                 }
                 ptr = strtok_r(NULL, "\n", &save1);
@@ -359,6 +367,11 @@ void execute_load(DbOperator *query, message *send_message)
                     build_secondary_index(&current_table->columns[i], current_table->columns[i].btree);
                 }
             }
+            // zone maps are built last, once the primary index has settled the row order
+            for (size_t i = 0; i < current_table->col_count; i++)
+            {
+                build_zone_map(&current_table->columns[i]);
+            }
             load_message_header.status = OK_DONE;
             send(query->client_fd, &load_message_header, sizeof(message), 0);
         }
@@ -367,257 +380,401 @@ void execute_load(DbOperator *query, message *send_message)
     send_message->status = OK_DONE;
 }
 
-void execute_select(DbOperator *query, message *send_message)
+// keeps the set bits of bits whose value, taken in position order from values, lies in [low, high]
+#define FILTER_BITMAP(TYPE)                                                        \
+    {                                                                              \
+        TYPE *values = value_vector->payload;                                      \
+        size_t j = 0;                                                              \
+        for (size_t w = 0; w < num_words; w++)                                     \
+        {                                                                          \
+            uint64_t word = bits[w];                                               \
+            uint64_t selected = 0;                                                 \
+            while (word)                                                           \
+            {                                                                      \
+                uint64_t bit = word & -word;                                       \
+                selected |= (values[j] >= low) & (values[j] <= high) ? bit : 0;    \
+                j++;                                                               \
+                word ^= bit;                                                       \
+            }                                                                      \
+            select_bits[w] = selected;                                             \
+            index += __builtin_popcountll(selected);                               \
+        }                                                                          \
+    }
+
+// TWO_COLUMN select whose position vector is a bitmap, the selected positions stay a bitmap
+Result *select_bitmap_positions(Result *position_vector, Result *value_vector, int low, int high)
 {
-    // TODO: do we need to modify TWO_COLUMN select to use indexing?
-    if (query->operator_fields.select_operator.select_type == TWO_COLUMN)
+    uint64_t *bits = position_vector->payload;
+    size_t num_words = bitmap_words(position_vector->num_rows);
+    uint64_t *select_bits = malloc(num_words * sizeof(uint64_t));
+    size_t index = 0;
+    if (value_vector->data_type == INT)
+        FILTER_BITMAP(int)
+    else if (value_vector->data_type == LONG)
+        FILTER_BITMAP(long)
+    else if (value_vector->data_type == FLOAT)
+        FILTER_BITMAP(float)
+    else
+        FILTER_BITMAP(double)
+
+    Result *result = malloc(sizeof(Result));
+    result->format = BITMAP;
+    result->data_type = LONG;
+    result->num_tuples = index;
+    result->num_rows = position_vector->num_rows;
+    result->payload = select_bits;
+    return result;
+}
+
+// fraction of an evenly strided sample of values in [low, high], to size TWO_COLUMN select outputs
+double sample_selectivity(Result *value_vector, int low, int high)
+{
+    size_t length = value_vector->num_tuples;
+    size_t step = length / SELECTIVITY_SAMPLE_SIZE + 1;
+    size_t sampled = 0;
+    size_t hits = 0;
+    for (size_t i = 0; i < length; i += step)
     {
-        Result *position_vector = lookup_variables(NULL, NULL, NULL, query->operator_fields.select_operator.position_vector, query->context)->column_pointer.result;
-        Result *value_vector = lookup_variables(NULL, NULL, NULL, query->operator_fields.select_operator.value_vector, query->context)->column_pointer.result;
-        int low = query->operator_fields.select_operator.low;
-        int high = query->operator_fields.select_operator.high;
-        if (position_vector->data_type == FLOAT)
-        {
-            send_message->status = INCORRECT_FORMAT;
-        }
+        double value;
+        if (value_vector->data_type == INT)
+            value = ((int *)value_vector->payload)[i];
+        else if (value_vector->data_type == LONG)
+            value = ((long *)value_vector->payload)[i];
+        else if (value_vector->data_type == FLOAT)
+            value = ((float *)value_vector->payload)[i];
+        else
+            value = ((double *)value_vector->payload)[i];
+        hits += (value >= low) & (value <= high);
+        sampled++;
+    }
+    return sampled ? hits * 1.0 / sampled : 0;
+}
+
+// TWO_COLUMN select over a position array, through the kernel family for the value type
+Result *select_positions(Result *position_vector, Result *value_vector, int low, int high)
+{
+    size_t length = position_vector->num_tuples;
+    size_t *positions = position_vector->payload;
+    PositionBuffer buffer;
+    position_buffer_init(&buffer, sample_selectivity(value_vector, low, high) * length);
+    if (length >= PARALLEL_SELECT_THRESHOLD)
+    {
+        if (value_vector->data_type == INT)
+            parallel_filter_positions_int(positions, value_vector->payload, length, low, high, &buffer);
+        else if (value_vector->data_type == LONG)
+            parallel_filter_positions_long(positions, value_vector->payload, length, low, high, &buffer);
+        else if (value_vector->data_type == FLOAT)
+            parallel_filter_positions_float(positions, value_vector->payload, length, low, high, &buffer);
         else
+            parallel_filter_positions_double(positions, value_vector->payload, length, low, high, &buffer);
+    }
+    else
+    {
+        // block by block, so the buffer only has to grow by one block past the estimate
+        for (size_t start = 0; start < length; start += ZONE_SIZE)
         {
+            size_t end = start + ZONE_SIZE < length ? start + ZONE_SIZE : length;
+            size_t *out = position_buffer_reserve(&buffer, end - start);
             if (value_vector->data_type == INT)
-            {
-                // map context file
-                size_t *select_data = malloc(value_vector->num_tuples * sizeof(size_t));
+                buffer.length += filter_positions_int(positions, value_vector->payload, start, end, low, high, out);
+            else if (value_vector->data_type == LONG)
+                buffer.length += filter_positions_long(positions, value_vector->payload, start, end, low, high, out);
+            else if (value_vector->data_type == FLOAT)
+                buffer.length += filter_positions_float(positions, value_vector->payload, start, end, low, high, out);
+            else
+                buffer.length += filter_positions_double(positions, value_vector->payload, start, end, low, high, out);
+        }
+    }
 
-                size_t index = 0;
-                size_t *positions = position_vector->payload;
-                int *values = value_vector->payload;
-                for (size_t i = 0; i < position_vector->num_tuples; i++)
-                {
-                    // select_data[index] = positions[i];
-                    // index += (values[i] >= low) & (values[i] <= high);
-                    if (values[i] >= low && values[i] <= high)
-                        select_data[index++] = positions[i];
-                }
+    Result *result = malloc(sizeof(Result));
+    result->format = MATERIALIZED;
+    result->data_type = LONG;
+    result->num_tuples = buffer.length;
+    result->payload = position_buffer_finish(&buffer);
+    return result;
+}
 
-                // insert selected positions to client context
-                ClientContext *client_context = query->context;
-                Result *result = malloc(sizeof(Result));
-                result->data_type = LONG;
-                result->num_tuples = index;
-                result->payload = select_data;
-                add_context(result, client_context, query->operator_fields.select_operator.intermediate);
-            }
-            else if (value_vector->data_type == LONG)
-            {
-                // map context file
-                size_t *select_data = malloc(value_vector->num_tuples * sizeof(size_t));
+// keeps the positions of ranges whose value, taken in position order from values, lies in [low, high]
+#define FILTER_RANGES(TYPE)                                                        \
+    {                                                                              \
+        TYPE *values = value_vector->payload;                                      \
+        size_t j = 0;                                                              \
+        for (size_t r = 0; r < position_vector->num_ranges; r++)                   \
+        {                                                                          \
+            for (size_t block = ranges[r].start; block < ranges[r].end;            \
+                 block += ZONE_SIZE)                                               \
+            {                                                                      \
+                size_t block_end = block + ZONE_SIZE < ranges[r].end               \
+                                       ? block + ZONE_SIZE                         \
+                                       : ranges[r].end;                            \
+                size_t *out = position_buffer_reserve(&buffer, block_end - block); \
+                size_t k = 0;                                                      \
+                for (size_t i = block; i < block_end; i++, j++)                    \
+                {                                                                  \
+                    out[k] = i;                                                    \
+                    k += (values[j] >= low) & (values[j] <= high);                 \
+                }                                                                  \
+                buffer.length += k;                                                \
+            }                                                                      \
+        }                                                                          \
+    }
 
-                size_t index = 0;
-                size_t *positions = position_vector->payload;
-                long *values = value_vector->payload;
-                for (size_t i = 0; i < position_vector->num_tuples; i++)
-                {
-                    // select_data[index] = positions[i];
-                    // index += (values[i] >= low) & (values[i] <= high);
-                    if (values[i] >= low && values[i] <= high)
-                        select_data[index++] = positions[i];
-                }
+// TWO_COLUMN select whose position vector is range encoded
+Result *select_ranged_positions(Result *position_vector, Result *value_vector, int low, int high)
+{
+    PositionRange *ranges = position_vector->payload;
+    PositionBuffer buffer;
+    position_buffer_init(&buffer, sample_selectivity(value_vector, low, high) * position_vector->num_tuples);
+    if (value_vector->data_type == INT)
+        FILTER_RANGES(int)
+    else if (value_vector->data_type == LONG)
+        FILTER_RANGES(long)
+    else if (value_vector->data_type == FLOAT)
+        FILTER_RANGES(float)
+    else
+        FILTER_RANGES(double)
 
-                // insert selected positions to client context
-                ClientContext *client_context = query->context;
-                Result *result = malloc(sizeof(Result));
-                result->data_type = LONG;
-                result->num_tuples = index;
-                result->payload = select_data;
-                add_context(result, client_context, query->operator_fields.select_operator.intermediate);
-            }
-            else
-            {
-                // map context file
-                size_t *select_data = malloc(value_vector->num_tuples * sizeof(size_t));
+    Result *result = malloc(sizeof(Result));
+    result->format = MATERIALIZED;
+    result->data_type = LONG;
+    result->num_tuples = buffer.length;
+    result->payload = position_buffer_finish(&buffer);
+    return result;
+}
 
-                size_t index = 0;
-                size_t *positions = position_vector->payload;
-                float *values = value_vector->payload;
-                for (size_t i = 0; i < position_vector->num_tuples; i++)
-                {
-                    // select_data[index] = positions[i];
-                    // index += (values[i] >= low) & (values[i] <= high);
-                    if (values[i] >= low && values[i] <= high)
-                        select_data[index++] = positions[i];
-                }
-                // insert selected positions to client context
-                ClientContext *client_context = query->context;
-                Result *result = malloc(sizeof(Result));
-                result->data_type = LONG;
-                result->num_tuples = index;
-                result->payload = select_data;
-                add_context(result, client_context, query->operator_fields.select_operator.intermediate);
-            }
-        }
+// rows of the column in [low, high], into a buffer sized from the selectivity estimate
+size_t *scan_positions(Column *column, size_t column_length, int low, int high, size_t *num_positions)
+{
+    const int *zone_min = column->zone_map ? column->zone_map->min : NULL;
+    const int *zone_max = column->zone_map ? column->zone_map->max : NULL;
+    PositionBuffer buffer;
+    position_buffer_init(&buffer, estimate_selectivity(column, low, high) * column_length);
+    if (column_length >= PARALLEL_SELECT_THRESHOLD)
+    {
+        parallel_select_range(column->data, column_length, zone_min, zone_max, low, high, &buffer);
     }
     else
     {
-        Column *column = query->operator_fields.select_operator.column;
-        int low = query->operator_fields.select_operator.low;
-        int high = query->operator_fields.select_operator.high;
-        // map context file
-        size_t *select_data = malloc(query->operator_fields.select_operator.column_length * sizeof(size_t));
-        size_t index = 0;
-        // if primary index
-        if (column->clustered)
-        {
-            ColumnSelectType column_select_type = optimize(column, low, high);
-            if (column_select_type == RANDOM_ACCESS)
+        for (size_t start = 0; start < column_length; start += ZONE_SIZE)
+        {
+            size_t end = start + ZONE_SIZE < column_length ? start + ZONE_SIZE : column_length;
+            buffer.length += select_range_zoned(column->data, start, end, zone_min, zone_max, low, high, position_buffer_reserve(&buffer, end - start));
+        }
+    }
+    *num_positions = buffer.length;
+    return position_buffer_finish(&buffer);
+}
+
+/*
+ * [*index_low, *index_high) of the sorted values in [low, high]: the btree gives
+ * positions near both bounds, which are then settled on the values themselves
+ */
+static void btree_bounds(BTNode *root, const int *values, size_t length, int low, int high, size_t *index_low, size_t *index_high)
+{
+    size_t lo = search_position(root, low);
+    size_t hi = search_position(root, high);
+    lo = lo < length ? lo : length;
+    hi = hi < length ? hi : length;
+    while (lo > 0 && values[lo - 1] >= low)
+        lo--;
+    while (lo < length && values[lo] < low)
+        lo++;
+    while (hi > 0 && values[hi - 1] > high)
+        hi--;
+    while (hi < length && values[hi] <= high)
+        hi++;
+    *index_low = lo;
+    *index_high = hi > lo ? hi : lo;
+}
+
+// eager ONE_COLUMN select: through the column's index when it has one, otherwise a zone-pruned scan
+Result *select_column(Column *column, size_t column_length, int low, int high)
+{
+    size_t *select_data = NULL;
+    uint64_t *select_bits = NULL;
+    PositionRange *select_ranges = NULL;
+    size_t num_ranges = 0;
+    const int *zone_min;
+    const int *zone_max;
+    size_t index = 0;
+    // if primary index
+    if (column->clustered)
+    {
+        ColumnSelectType column_select_type = optimize(column, low, high);
+        if (column_select_type == RANDOM_ACCESS)
+        {
+            // the rows of a clustered column are in value order, the selected positions are one range
+            select_ranges = malloc(sizeof(PositionRange));
+            if (column->btree)
             {
-                if (column->btree)
-                {
-                    long index_low = search_position(column->btree_root, low);
-                    size_t index_high = search_position(column->btree_root, high);
-                    // search_position returns the position that is greater or equal to target
-                    while ((index_low >= 0) && (column->data[index_low] >= low))
-                    {
-                        index_low--;
-                    }
-                    while (column->data[index_low] < low)
-                    {
-                        index_low++;
-                    }
-                    while ((index_high < column->length) && (column->data[index_high] <= high))
-                    {
-                        index_high++;
-                    }
-                    while (column->data[index_high] > high)
-                    {
-                        index_high--;
-                    }
-                    for (size_t i = index_low; (i <= index_high) && (i < column->length); i++)
-                    {
-                        select_data[index++] = i;
-                    }
-                }
-                else
-                { // sorted non btree primary index
-                    size_t index_low = binary_search_index(column->data, column->length, low);
-                    size_t index_high = binary_search_index(column->data, column->length, high);
-                    // search_index returns the index that is greater or equal to target
-                    while (column->data[index_low] == low)
-                    {
-                        index_low--;
-                    }
-                    while (column->data[index_low] < low)
-                    {
-                        index_low++;
-                    }
-                    while (column->data[index_high] == high)
-                    {
-                        index_high++;
-                    }
-                    while (column->data[index_high] > high)
-                    {
-                        index_high--;
-                    }
-                    for (size_t i = index_low; i <= index_high; i++)
-                    {
-                        select_data[index++] = i;
-                    }
-                }
+                size_t index_low, index_high;
+                btree_bounds(column->btree_root, column->data, column->length, low, high, &index_low, &index_high);
+                select_ranges->start = index_low;
+                select_ranges->end = index_high;
             }
             else
+            { // sorted non btree primary index
+                select_ranges->start = lower_bound_index(column->data, column->length, low);
+                select_ranges->end = lower_bound_index(column->data, column->length, (long)high + 1);
+            }
+            if (select_ranges->end < select_ranges->start)
             {
-                goto sequential_select;
+                select_ranges->end = select_ranges->start;
             }
+            index = select_ranges->end - select_ranges->start;
+            num_ranges = index > 0;
+        }
+        else
+        {
+            goto sequential_select;
         }
-        else if (column->btree)
+    }
+    else if (column->btree)
+    {
+        ColumnSelectType column_select_type = optimize(column, low, high);
+        if (column_select_type == RANDOM_ACCESS)
         {
-            ColumnSelectType column_select_type = optimize(column, low, high);
-            if (column_select_type == RANDOM_ACCESS)
+            size_t index_low, index_high;
+            btree_bounds(column->btree_root, column->index->values, column->length, low, high, &index_low, &index_high);
+            // the index bounds give the exact number of positions
+            select_data = malloc((index_high > index_low ? index_high - index_low : 1) * sizeof(size_t));
+            for (size_t i = index_low; i < index_high; i++)
             {
-                long index_low = search_position(column->btree_root, low);
-                size_t index_high = search_position(column->btree_root, high);
-                // print_btree(column->btree_root, 0);
-                // search_position returns the position that is greater or equal to target
-                while ((index_low >= 0) && (column->index->values[index_low] >= low))
-                {
-                    index_low--;
-                }
-                while (column->index->values[index_low] < low)
-                {
-                    index_low++;
-                }
-
-                while ((index_high < column->length) && (column->index->values[index_high] <= high))
-                {
-                    index_high++;
-                }
-                while (column->index->values[index_high] > high)
-                {
-                    index_high--;
-                }
-                for (size_t i = index_low; (i <= index_high) && (i < column->length); i++)
-                {
-                    select_data[index++] = column->index->positions[i];
-                }
+                select_data[index++] = column->index->positions[i];
             }
-            else
+        }
+        else
+        {
+            goto sequential_select;
+        }
+    }
+    else if (column->sorted)
+    {
+        ColumnSelectType column_select_type = optimize(column, low, high);
+        if (column_select_type == RANDOM_ACCESS)
+        {
+            size_t index_low = lower_bound_index(column->index->values, column->length, low);
+            size_t index_high = lower_bound_index(column->index->values, column->length, (long)high + 1);
+            select_data = malloc((index_high > index_low ? index_high - index_low : 1) * sizeof(size_t));
+            for (size_t i = index_low; i < index_high; i++)
+            {
+                select_data[index++] = column->index->positions[i];
+            }
+            qsort(select_data, index, sizeof(size_t), int_cmp);
+            // a sorted index on a column correlated with the row order yields long runs of positions
+            num_ranges = positions_to_ranges(select_data, index, index / RANGE_ENCODE_RATIO, &select_ranges);
+            if (num_ranges)
             {
-                goto sequential_select;
+                free(select_data);
+                select_data = NULL;
             }
         }
-        else if (column->sorted)
+        else
+        {
+            goto sequential_select;
+        }
+    }
+    else
+    {
+    sequential_select:
+        // zones that cannot match are skipped, zones inside the range are taken whole
+        zone_min = column->zone_map ? column->zone_map->min : NULL;
+        zone_max = column->zone_map ? column->zone_map->max : NULL;
+        if (choose_position_format(column, low, high) == BITMAP)
         {
-            ColumnSelectType column_select_type = optimize(column, low, high);
-            if (column_select_type == RANDOM_ACCESS)
+            select_bits = malloc(bitmap_words(column_length) * sizeof(uint64_t));
+            if (column_length >= PARALLEL_SELECT_THRESHOLD)
             {
-                size_t index_low = binary_search_index(column->index->values, column->length, low);
-                size_t index_high = binary_search_index(column->index->values, column->length, high);
-                // search_index returns the index that is greater or equal to target
-                while (column->index->values[index_low] == low)
-                {
-                    index_low--;
-                }
-                while (column->index->values[index_low] < low)
-                {
-                    index_low++;
-                }
-
-                while (column->index->values[index_high] == high)
-                {
-                    index_high++;
-                }
-                while (column->index->values[index_high] > high)
-                {
-                    index_high--;
-                }
-                for (size_t i = index_low; i <= index_high; i++)
-                {
-                    select_data[index++] = column->index->positions[i];
-                }
-                qsort(select_data, index, sizeof(size_t), int_cmp);
+                index = parallel_select_bitmap(column->data, column_length, zone_min, zone_max, low, high, select_bits);
             }
             else
             {
-                goto sequential_select;
+                index = select_bitmap_zoned(column->data, 0, column_length, zone_min, zone_max, low, high, select_bits);
             }
         }
         else
         {
-        sequential_select:
-            for (size_t i = 0; i < query->operator_fields.select_operator.column_length; i++)
-            {
-                // select_data[index] = i;
-                // index += (column->data[i] >= low) & (column->data[i] <= high);
-                if (column->data[i] >= low && column->data[i] <= high)
-                    select_data[index++] = i;
-            }
+            select_data = scan_positions(column, column_length, low, high, &index);
         }
+    }
 
-        // insert selected positions to client context
-        ClientContext *client_context = query->context;
-        Result *result = malloc(sizeof(Result));
-        result->data_type = LONG;
-        result->num_tuples = index;
+    Result *result = malloc(sizeof(Result));
+    result->data_type = LONG;
+    result->num_tuples = index;
+    if (select_bits)
+    {
+        result->format = BITMAP;
+        result->num_rows = column_length;
+        result->payload = select_bits;
+    }
+    else if (select_ranges)
+    {
+        result->format = RANGES;
+        result->num_ranges = num_ranges;
+        result->payload = select_ranges;
+    }
+    else
+    {
+        result->format = MATERIALIZED;
         result->payload = select_data;
-        add_context(result, client_context, query->operator_fields.select_operator.intermediate);
+    }
+    return result;
+}
+
+void execute_select(DbOperator *query, message *send_message)
+{
+    // TODO: do we need to modify TWO_COLUMN select to use indexing?
+    if (query->operator_fields.select_operator.select_type == TWO_COLUMN)
+    {
+        Result *position_vector = lookup_variables(NULL, NULL, NULL, query->operator_fields.select_operator.position_vector, query->context)->column_pointer.result;
+        Result *value_vector = lookup_variables(NULL, NULL, NULL, query->operator_fields.select_operator.value_vector, query->context)->column_pointer.result;
+        int low = query->operator_fields.select_operator.low;
+        int high = query->operator_fields.select_operator.high;
+        // a select over values fetched at the deferred positions joins their pipeline
+        PipelineNode *filter = NULL;
+        if (position_vector->format == DEFERRED && value_vector->format == DEFERRED)
+        {
+            filter = pipeline_filter(position_vector->payload, value_vector->payload, low, high);
+        }
+        if (filter)
+        {
+            add_context(pipeline_result(filter), query->context, query->operator_fields.select_operator.intermediate);
+            send_message->status = OK_DONE;
+            return;
+        }
+        Result *operands[2] = {position_vector, value_vector};
+        evaluate_results(operands, 2);
+        if (position_vector->data_type == FLOAT)
+        {
+            send_message->status = INCORRECT_FORMAT;
+        }
+        else if (position_vector->format == BITMAP)
+        {
+            add_context(select_bitmap_positions(position_vector, value_vector, low, high), query->context, query->operator_fields.select_operator.intermediate);
+        }
+        else if (position_vector->format == RANGES)
+        {
+            add_context(select_ranged_positions(position_vector, value_vector, low, high), query->context, query->operator_fields.select_operator.intermediate);
+        }
+        else
+        {
+            add_context(select_positions(position_vector, value_vector, low, high), query->context, query->operator_fields.select_operator.intermediate);
+        }
+    }
+    else
+    {
+        Column *column = query->operator_fields.select_operator.column;
+        int low = query->operator_fields.select_operator.low;
+        int high = query->operator_fields.select_operator.high;
+        size_t column_length = query->operator_fields.select_operator.column_length;
+        // selects on unindexed columns are deferred, the scan runs once a statement needs the positions
+        if (!column->clustered && !column->btree && !column->sorted)
+        {
+            add_context(pipeline_result(pipeline_scan(column, column_length, low, high)), query->context, query->operator_fields.select_operator.intermediate);
+            send_message->status = OK_DONE;
+            return;
+        }
+        add_context(select_column(column, column_length, low, high), query->context, query->operator_fields.select_operator.intermediate);
     }
 
     if (query->context->batch_mode)
@@ -649,73 +806,17 @@ void batch_execute_select(void *args)
             send_message->status = INCORRECT_FORMAT;
             pthread_mutex_unlock(&lock);
         }
+        else if (position_vector->format == BITMAP)
+        {
+            add_context(select_bitmap_positions(position_vector, value_vector, low, high), query->context, query->operator_fields.select_operator.intermediate);
+        }
+        else if (position_vector->format == RANGES)
+        {
+            add_context(select_ranged_positions(position_vector, value_vector, low, high), query->context, query->operator_fields.select_operator.intermediate);
+        }
         else
         {
-            if (value_vector->data_type == INT)
-            {
-                // map context file
-                size_t *select_data = malloc(value_vector->num_tuples * sizeof(size_t));
-
-                size_t index = 0;
-                size_t *positions = position_vector->payload;
-                int *values = value_vector->payload;
-                for (size_t i = 0; i < position_vector->num_tuples; i++)
-                {
-                    select_data[index] = positions[i];
-                    index += (values[i] >= low) & (values[i] <= high);
-                }
-
-                // insert selected positions to client context
-                ClientContext *client_context = query->context;
-                Result *result = malloc(sizeof(Result));
-                result->data_type = LONG;
-                result->num_tuples = index;
-                result->payload = select_data;
-                add_context(result, client_context, query->operator_fields.select_operator.intermediate);
-            }
-            else if (value_vector->data_type == LONG)
-            {
-                // map context file
-                size_t *select_data = malloc(value_vector->num_tuples * sizeof(size_t));
-
-                size_t index = 0;
-                size_t *positions = position_vector->payload;
-                long *values = value_vector->payload;
-                for (size_t i = 0; i < position_vector->num_tuples; i++)
-                {
-                    select_data[index] = positions[i];
-                    index += (values[i] >= low) & (values[i] <= high);
-                }
-
-                // insert selected positions to client context
-                ClientContext *client_context = query->context;
-                Result *result = malloc(sizeof(Result));
-                result->data_type = LONG;
-                result->num_tuples = index;
-                result->payload = select_data;
-                add_context(result, client_context, query->operator_fields.select_operator.intermediate);
-            }
-            else
-            {
-                // map context file
-                size_t *select_data = malloc(value_vector->num_tuples * sizeof(size_t));
-
-                size_t index = 0;
-                size_t *positions = position_vector->payload;
-                float *values = value_vector->payload;
-                for (size_t i = 0; i < position_vector->num_tuples; i++)
-                {
-                    select_data[index] = positions[i];
-                    index += (values[i] >= low) & (values[i] <= high);
-                }
-                // insert selected positions to client context
-                ClientContext *client_context = query->context;
-                Result *result = malloc(sizeof(Result));
-                result->data_type = LONG;
-                result->num_tuples = index;
-                result->payload = select_data;
-                add_context(result, client_context, query->operator_fields.select_operator.intermediate);
-            }
+            add_context(select_positions(position_vector, value_vector, low, high), query->context, query->operator_fields.select_operator.intermediate);
         }
     }
     else
@@ -723,20 +824,13 @@ void batch_execute_select(void *args)
         Column *column = query->operator_fields.select_operator.column;
         int low = query->operator_fields.select_operator.low;
         int high = query->operator_fields.select_operator.high;
-        // map context file
-        size_t *select_data = malloc(query->operator_fields.select_operator.column_length * sizeof(size_t));
-
-        size_t index = 0;
-
-        for (size_t i = 0; i < query->operator_fields.select_operator.column_length; i++)
-        {
-            select_data[index] = i;
-            index += (column->data[i] >= low) & (column->data[i] <= high);
-        }
+        size_t index;
+        size_t *select_data = scan_positions(column, query->operator_fields.select_operator.column_length, low, high, &index);
 
         // insert selected positions to client context
         ClientContext *client_context = query->context;
         Result *result = malloc(sizeof(Result));
+        result->format = MATERIALIZED;
         result->data_type = LONG;
         result->num_tuples = index;
         result->payload = select_data;
@@ -756,451 +850,498 @@ void batch_execute_select(void *args)
     free(arguments);
 }
 
-void execute_fetch(DbOperator *query, message *send_message)
+// true when the positions are one run of consecutive rows, the first of which is stored in start
+bool contiguous_positions(Result *positions, size_t *start)
 {
-    Column *column = query->operator_fields.fetch_operator.column;
-    // char* intermediate = query->operator_fields.fetch_operator.intermediate; // Error!!!!!! strcpy for intermediate
+    if (positions->num_tuples == 0)
+        return false;
+    if (positions->format == RANGES)
+    {
+        *start = ((PositionRange *)positions->payload)->start;
+        return positions->num_ranges == 1;
+    }
+    if (positions->format == BITMAP)
+    {
+        size_t last;
+        bitmap_first(positions->payload, positions->num_rows, start);
+        bitmap_last(positions->payload, positions->num_rows, &last);
+        return last - *start + 1 == positions->num_tuples;
+    }
+    size_t *data = positions->payload;
+    for (size_t i = 1; i < positions->num_tuples; i++)
+    {
+        if (data[i] != data[i - 1] + 1)
+            return false;
+    }
+    *start = data[0];
+    return true;
+}
 
-    size_t *positions;
-    size_t positions_len;
-    // find specified positions vector in client context
-    // TODO: extract find_context function later
+void execute_fetch(DbOperator *query, message *send_message)
+{
+    FetchOperator *fetch = &query->operator_fields.fetch_operator;
     ClientContext *client_context = query->context;
+    // every output is built before any is stored, an output may replace the positions themselves
+    Result *results[MAX_FETCH_COLUMNS];
 
-    GeneralizedColumn *generalized_column = lookup_variables(NULL, NULL, NULL, query->operator_fields.fetch_operator.positions, client_context);
-    positions = generalized_column->column_pointer.result->payload;
-    positions_len = generalized_column->column_pointer.result->num_tuples;
-
+    GeneralizedColumn *generalized_column = lookup_variables(NULL, NULL, NULL, fetch->positions, client_context);
     // return if variable not found
-    if (!positions)
+    if (!generalized_column || !generalized_column->column_pointer.result)
     {
         cs165_log(stdout, "Variable not found in variable pool.");
         send_message->status = EXECUTION_ERROR;
         return;
     }
-
-    // allocate memory for context file
-    int *fetch_data = malloc(positions_len * sizeof(int));
-    // fetch data
-    for (size_t i = 0; i < positions_len; i++)
+    if (generalized_column->column_pointer.result->format == DEFERRED)
     {
-        fetch_data[i] = column->data[positions[i]];
+        PipelineNode *positions = generalized_column->column_pointer.result->payload;
+        PipelineNode *first = pipeline_fetch(fetch->columns[0], positions);
+        if (first)
+        {
+            results[0] = pipeline_result(first);
+            for (size_t c = 1; c < fetch->num_columns; c++)
+                results[c] = pipeline_result(pipeline_fetch(fetch->columns[c], positions));
+            for (size_t c = 0; c < fetch->num_columns; c++)
+                add_context(results[c], client_context, fetch->intermediates[c]);
+            send_message->status = OK_DONE;
+            return;
+        }
+        evaluate_results(&generalized_column->column_pointer.result, 1);
     }
-    Result *result = malloc(sizeof(Result));
-    result->data_type = INT;
-    result->num_tuples = positions_len;
-    result->payload = fetch_data;
-    add_context(result, client_context, query->operator_fields.fetch_operator.intermediate);
-    send_message->status = OK_DONE;
-}
-
-void execute_aggregate(DbOperator *query, message *send_message)
-{
-    ClientContext *client_context = query->context;
-    AggregateType agg_type = query->operator_fields.aggregate_operator.aggregate_type;
-    Result *result = malloc(sizeof(Result));
-    if (agg_type == SUM || agg_type == AVG)
+    Result *positions = generalized_column->column_pointer.result;
+    size_t positions_len = positions->num_tuples;
+
+    // consecutive positions borrow the column's values instead of copying them
+    size_t start;
+    bool contiguous = contiguous_positions(positions, &start);
+    const int *columns[MAX_FETCH_COLUMNS];
+    int *outs[MAX_FETCH_COLUMNS];
+    for (size_t c = 0; c < fetch->num_columns; c++)
     {
-        GeneralizedColumn *gc1 = query->operator_fields.aggregate_operator.gc1;
-        if (gc1->column_type == RESULT)
-        { // result
-            if (gc1->column_pointer.result->data_type == FLOAT)
-            {
-                result->data_type = DOUBLE;
+        Column *column = fetch->columns[c];
+        Result *result = malloc(sizeof(Result));
+        result->data_type = INT;
+        result->num_tuples = positions_len;
+        if (contiguous)
+        {
+            result->format = VIEW;
+            result->mapping = acquire_mapping(column);
+            result->payload = column->data + start;
+        }
+        else
+        {
+            result->format = MATERIALIZED;
+            result->payload = malloc(positions_len * sizeof(int));
+        }
+        columns[c] = column->data;
+        outs[c] = result->payload;
+        results[c] = result;
+    }
+    if (!contiguous && positions->format == BITMAP)
+    {
+        for (size_t c = 0; c < fetch->num_columns; c++)
+            bitmap_fetch(positions->payload, positions->num_rows, fetch->columns[c]->data, outs[c]);
+    }
+    else if (!contiguous && positions->format == RANGES)
+    {
+        // every range is a contiguous slice of the column
+        for (size_t c = 0; c < fetch->num_columns; c++)
+            ranges_fetch(positions->payload, positions->num_ranges, fetch->columns[c]->data, outs[c]);
+    }
+    else if (!contiguous)
+    {
+        // the columns are gathered together in one pass over the positions
+        parallel_fetch_columns(columns, fetch->num_columns, positions->payload, positions_len, outs);
+    }
+    for (size_t c = 0; c < fetch->num_columns; c++)
+        add_context(results[c], client_context, fetch->intermediates[c]);
+    send_message->status = OK_DONE;
+}
 
-                double *result_data = malloc(1 * sizeof(double));
-                *result_data = 0.0;
+// SUM/AVG/MIN/MAX over bitmap positions, typed like the same aggregate over a LONG position vector
+void aggregate_bitmap(Result *bitmap, AggregateType agg_type, Result *result)
+{
+    uint64_t *bits = bitmap->payload;
+    if (agg_type == AVG)
+    {
+        double *result_data = malloc(1 * sizeof(double));
+        *result_data = bitmap->num_tuples != 0 ? bitmap_sum(bits, bitmap->num_rows) * 1.0 / bitmap->num_tuples : 0;
+        result->data_type = DOUBLE;
+        result->payload = result_data;
+    }
+    else
+    {
+        long *result_data = malloc(1 * sizeof(long));
+        size_t position;
+        if (agg_type == SUM)
+            *result_data = bitmap_sum(bits, bitmap->num_rows);
+        else if (agg_type == MAX)
+            *result_data = bitmap_last(bits, bitmap->num_rows, &position) ? (long)position : -__INT_MAX__ - 1;
+        else
+            *result_data = bitmap_first(bits, bitmap->num_rows, &position) ? (long)position : __INT_MAX__;
+        result->data_type = LONG;
+        result->payload = result_data;
+    }
+    result->num_tuples = 1;
+}
 
-                float *payload = (float *)gc1->column_pointer.result->payload;
-                for (size_t i = 0; i < gc1->column_pointer.result->num_tuples; i++)
-                {
-                    *result_data += payload[i];
-                }
-                if (agg_type == AVG)
-                    *result_data = gc1->column_pointer.result->num_tuples != 0 ? *result_data / gc1->column_pointer.result->num_tuples : 0;
-                result->payload = result_data;
-                result->num_tuples = 1;
-            }
-            else if (gc1->column_pointer.result->data_type == INT)
-            {
+// SUM/AVG/MIN/MAX over range-encoded positions, read off the range bounds
+void aggregate_ranges(Result *ranged, AggregateType agg_type, Result *result)
+{
+    PositionRange *ranges = ranged->payload;
+    if (agg_type == AVG)
+    {
+        double *result_data = malloc(1 * sizeof(double));
+        *result_data = ranged->num_tuples != 0 ? ranges_sum(ranges, ranged->num_ranges) * 1.0 / ranged->num_tuples : 0;
+        result->data_type = DOUBLE;
+        result->payload = result_data;
+    }
+    else
+    {
+        long *result_data = malloc(1 * sizeof(long));
+        if (agg_type == SUM)
+            *result_data = ranges_sum(ranges, ranged->num_ranges);
+        else if (agg_type == MAX)
+            *result_data = ranged->num_ranges ? (long)ranges[ranged->num_ranges - 1].end - 1 : -__INT_MAX__ - 1;
+        else
+            *result_data = ranged->num_ranges ? (long)ranges[0].start : __INT_MAX__;
+        result->data_type = LONG;
+        result->payload = result_data;
+    }
+    result->num_tuples = 1;
+}
 
-                if (agg_type == AVG)
-                {
-                    result->data_type = DOUBLE;
+// SUM or AVG of length values through the parallel reduction kernels: integers sum exactly into a LONG, AVG is a DOUBLE
+void aggregate_sum(const void *data, DataType data_type, size_t length, AggregateType agg_type, Result *result)
+{
+    double sum;
+    if (data_type == INT || data_type == LONG)
+    {
+        long total = data_type == INT ? parallel_sum_int(data, length) : parallel_sum_long(data, length);
+        if (agg_type == SUM)
+        {
+            long *result_data = malloc(1 * sizeof(long));
+            *result_data = total;
+            result->data_type = LONG;
+            result->payload = result_data;
+            result->num_tuples = 1;
+            return;
+        }
+        sum = total;
+    }
+    else
+    {
+        sum = data_type == FLOAT ? parallel_sum_float(data, length) : parallel_sum_double(data, length);
+    }
+    double *result_data = malloc(1 * sizeof(double));
+    *result_data = agg_type == AVG ? (length != 0 ? sum / length : 0) : sum;
+    result->data_type = DOUBLE;
+    result->payload = result_data;
+    result->num_tuples = 1;
+}
 
-                    double *result_data = malloc(1 * sizeof(double));
-                    *result_data = 0.0;
-                    int *payload = (int *)gc1->column_pointer.result->payload;
-                    for (size_t i = 0; i < gc1->column_pointer.result->num_tuples; i++)
-                    {
-                        *result_data += payload[i];
-                    }
-                    *result_data = gc1->column_pointer.result->num_tuples != 0 ? *result_data / gc1->column_pointer.result->num_tuples : 0;
-                    result->payload = result_data;
-                    result->num_tuples = 1;
-                }
-                else
-                { // agg_type == SUM
-                    result->data_type = LONG;
+// MIN or MAX of length values in their own type; an empty input gives the INT sentinel
+void aggregate_minmax(const void *data, DataType data_type, size_t length, AggregateType agg_type, Result *result)
+{
+    if (data_type == INT)
+    {
+        int min = __INT_MAX__, max = -__INT_MAX__ - 1;
+        parallel_minmax_int(data, length, &min, &max);
+        int *result_data = malloc(1 * sizeof(int));
+        *result_data = agg_type == MAX ? max : min;
+        result->payload = result_data;
+    }
+    else if (data_type == LONG)
+    {
+        // wider values can lie outside the INT sentinels, so a non-empty input starts from its first value
+        long min = length ? ((const long *)data)[0] : __INT_MAX__;
+        long max = length ? ((const long *)data)[0] : -__INT_MAX__ - 1;
+        parallel_minmax_long(data, length, &min, &max);
+        long *result_data = malloc(1 * sizeof(long));
+        *result_data = agg_type == MAX ? max : min;
+        result->payload = result_data;
+    }
+    else if (data_type == FLOAT)
+    {
+        float min = length ? ((const float *)data)[0] : __INT_MAX__;
+        float max = length ? ((const float *)data)[0] : -__INT_MAX__ - 1;
+        parallel_minmax_float(data, length, &min, &max);
+        float *result_data = malloc(1 * sizeof(float));
+        *result_data = agg_type == MAX ? max : min;
+        result->payload = result_data;
+    }
+    else
+    {
+        double min = length ? ((const double *)data)[0] : __INT_MAX__;
+        double max = length ? ((const double *)data)[0] : -__INT_MAX__ - 1;
+        parallel_minmax_double(data, length, &min, &max);
+        double *result_data = malloc(1 * sizeof(double));
+        *result_data = agg_type == MAX ? max : min;
+        result->payload = result_data;
+    }
+    result->data_type = data_type;
+    result->num_tuples = 1;
+}
 
-                    long *result_data = malloc(1 * sizeof(long));
-                    *result_data = 0;
+// the values of a column in ascending order when an index keeps them, NULL otherwise
+const int *index_values(Column *column)
+{
+    if (column->clustered)
+        return column->data;
+    if ((column->btree || column->sorted) && column->index)
+        return column->index->values;
+    return NULL;
+}
 
-                    int *payload = (int *)gc1->column_pointer.result->payload;
-                    for (size_t i = 0; i < gc1->column_pointer.result->num_tuples; i++)
-                    {
-                        *result_data += payload[i];
-                    }
-                    result->payload = result_data;
-                    result->num_tuples = 1;
-                }
-            }
-            else
-            { // LONG
-                result->data_type = LONG;
+// MIN or MAX of a whole indexed column: the first or last value in index order
+bool aggregate_column_index(Column *column, AggregateType agg_type, Result *result)
+{
+    const int *values = index_values(column);
+    if (!values || (agg_type != MIN && agg_type != MAX))
+        return false;
+    int *result_data = malloc(1 * sizeof(int));
+    if (column->length == 0)
+        *result_data = agg_type == MAX ? -__INT_MAX__ - 1 : __INT_MAX__;
+    else
+        *result_data = agg_type == MAX ? values[column->length - 1] : values[0];
+    result->data_type = INT;
+    result->payload = result_data;
+    result->num_tuples = 1;
+    return true;
+}
 
-                if (agg_type == AVG)
-                {
-                    result->data_type = DOUBLE;
+// SUM, AVG, MIN or MAX of a whole column from its catalog statistics; false when they do not cover every row
+bool aggregate_column_stats(Column *column, AggregateType agg_type, Result *result)
+{
+    ColumnStats *stats = &column->stats;
+    if (stats->count != column->length || stats->tombstones != 0)
+        return false;
+    if (agg_type == SUM)
+    {
+        long *result_data = malloc(1 * sizeof(long));
+        *result_data = stats->sum;
+        result->data_type = LONG;
+        result->payload = result_data;
+    }
+    else if (agg_type == AVG)
+    {
+        double *result_data = malloc(1 * sizeof(double));
+        *result_data = stats->count != 0 ? (double)stats->sum / stats->count : 0;
+        result->data_type = DOUBLE;
+        result->payload = result_data;
+    }
+    else
+    {
+        int *result_data = malloc(1 * sizeof(int));
+        *result_data = agg_type == MAX ? stats->max : stats->min;
+        result->data_type = INT;
+        result->payload = result_data;
+    }
+    result->num_tuples = 1;
+    return true;
+}
 
-                    long result_data = 0;
-                    double *avg_result = malloc(1 * sizeof(double));
-                    long *payload = (long *)gc1->column_pointer.result->payload;
-                    for (size_t i = 0; i < gc1->column_pointer.result->num_tuples; i++)
-                    {
-                        result_data += payload[i];
-                    }
-                    if (gc1->column_pointer.result->num_tuples != 0)
-                    {
-                        *avg_result = result_data * 1.0 / (1000 * gc1->column_pointer.result->num_tuples);
-                        *avg_result *= 1000;
-                    }
-                    else
-                    {
-                        *avg_result = 0;
-                    }
-                    result->payload = avg_result;
-                    result->num_tuples = 1;
-                }
-                else
-                { // agg_type == SUM
-                    result->data_type = LONG;
+// the values of an elementwise operand and how many there are
+static ArithOperand arith_operand(GeneralizedColumn *operand, size_t *length)
+{
+    ArithOperand values = {NULL, INT, false};
+    if (operand->column_type == RESULT)
+    {
+        values.data = operand->column_pointer.result->payload;
+        values.data_type = operand->column_pointer.result->data_type;
+        *length = operand->column_pointer.result->num_tuples;
+    }
+    else
+    {
+        values.data = operand->column_pointer.column->data;
+        *length = operand->column_pointer.column->length;
+    }
+    return values;
+}
 
-                    long *result_data = malloc(1 * sizeof(long));
-                    *result_data = 0;
-                    long *payload = (long *)gc1->column_pointer.result->payload;
-                    for (size_t i = 0; i < gc1->column_pointer.result->num_tuples; i++)
-                    {
-                        *result_data += payload[i];
-                    }
-                    result->payload = result_data;
-                    result->num_tuples = 1;
-                }
-            }
+/*
+ * ADD, SUB, MUL, DIV or NEG of materialized operands through the arith kernels.
+ * A one-value operand is broadcast against a vector. A result already held
+ * under the target name with the same type and length is overwritten in place
+ * rather than allocating a new vector for every evaluation.
+ */
+void execute_arith(DbOperator *query, message *send_message)
+{
+    AggregateOperator *op = &query->operator_fields.aggregate_operator;
+    AggregateType agg_type = op->aggregate_type;
+    int zero = 0;
+    size_t left_length = 1, right_length = 1, length = 0;
+    ArithOperand left = {&zero, INT, true};
+    ArithOperand right;
+    bool valid = true;
+    if (agg_type == NEG)
+    {
+        // -x is computed as 0 - x
+        right = arith_operand(op->gc1, &right_length);
+        length = right_length;
+        agg_type = SUB;
+        valid = op->variable_number == 1;
+    }
+    else if (op->variable_number == 2)
+    {
+        left = arith_operand(op->gc1, &left_length);
+        right = arith_operand(op->gc2, &right_length);
+        left.scalar = left_length == 1 && right_length != 1;
+        right.scalar = right_length == 1 && left_length != 1;
+        length = left.scalar ? right_length : left_length;
+        valid = left.scalar || right.scalar || left_length == right_length;
+    }
+    else
+    {
+        valid = false;
+    }
+
+    if (valid)
+    {
+        DataType data_type = arith_type(agg_type, left.data_type, right.data_type);
+        GeneralizedColumn *target = lookup_variables(NULL, NULL, NULL, op->intermediate, query->context);
+        Result *result = target && target->column_type == RESULT ? target->column_pointer.result : NULL;
+        if (result && result->format == MATERIALIZED && result->data_type == data_type && result->num_tuples == length &&
+            length > 0 && result->payload != left.data && result->payload != right.data)
+        {
+            arith(agg_type, left, right, result->payload, length);
         }
         else
-        { // column
-            if (agg_type == AVG)
-            {
-                result->data_type = FLOAT;
+        {
+            size_t width = data_type == FLOAT ? sizeof(float) : sizeof(long);
+            result = malloc(sizeof(Result));
+            result->format = MATERIALIZED;
+            result->data_type = data_type;
+            result->num_tuples = length;
+            result->payload = malloc((length > 0 ? length : 1) * width);
+            arith(agg_type, left, right, result->payload, length);
+            add_context(result, query->context, op->intermediate);
+        }
+    }
+    else
+    {
+        send_message->status = INCORRECT_FORMAT;
+    }
 
-                float *result_data = malloc(1 * sizeof(float));
-                *result_data = 0.0;
-                for (size_t i = 0; i < gc1->column_pointer.column->length; i++)
-                {
-                    *result_data += gc1->column_pointer.column->data[i];
-                }
-                *result_data = *result_data / gc1->column_pointer.column->length;
-                result->payload = result_data;
-                result->num_tuples = 1;
-            }
-            else
-            { // agg_type == SUM
-                result->data_type = LONG;
+    // operands looked up from the catalog or parsed from a literal belong to the operator
+    GeneralizedColumn *operands[2] = {op->gc1, op->variable_number == 2 ? op->gc2 : NULL};
+    for (int i = 0; i < 2; i++)
+    {
+        if (!operands[i])
+            continue;
+        if (operands[i]->column_type == COLUMN)
+        {
+            free(operands[i]);
+        }
+        else if (operands[i]->column_pointer.result == op->constant)
+        {
+            free_result(op->constant);
+            free(operands[i]);
+        }
+    }
+}
 
-                long *result_data = malloc(1 * sizeof(long));
-                *result_data = 0;
-                for (size_t i = 0; i < gc1->column_pointer.column->length; i++)
-                {
-                    *result_data += gc1->column_pointer.column->data[i];
-                }
-                result->payload = result_data;
-                result->num_tuples = 1;
-            }
+void execute_aggregate(DbOperator *query, message *send_message)
+{
+    ClientContext *client_context = query->context;
+    AggregateType agg_type = query->operator_fields.aggregate_operator.aggregate_type;
+    Result *result = malloc(sizeof(Result));
+    result->format = MATERIALIZED;
+    // aggregates and add/sub over deferred vectors extend their pipeline
+    GeneralizedColumn *gc1 = query->operator_fields.aggregate_operator.gc1;
+    GeneralizedColumn *gc2 = query->operator_fields.aggregate_operator.variable_number == 2 ? query->operator_fields.aggregate_operator.gc2 : NULL;
+    if (gc1->column_type == RESULT && gc1->column_pointer.result->format == DEFERRED)
+    {
+        PipelineNode *node = NULL;
+        if (agg_type == SUM || agg_type == AVG || agg_type == MAX || agg_type == MIN)
+        {
+            node = gc2 ? NULL : pipeline_aggregate(agg_type, gc1->column_pointer.result->payload);
+        }
+        else if ((agg_type == ADD || agg_type == SUB) && gc2 && gc2->column_type == RESULT && gc2->column_pointer.result->format == DEFERRED)
+        {
+            node = pipeline_arith(agg_type, gc1->column_pointer.result->payload, gc2->column_pointer.result->payload);
+        }
+        if (node)
+        {
+            free(result);
+            add_context(pipeline_result(node), client_context, query->operator_fields.aggregate_operator.intermediate);
+            return;
+        }
+    }
+    if (gc1->column_type == RESULT)
+    {
+        evaluate_results(&gc1->column_pointer.result, 1);
+    }
+    if (gc2 && gc2->column_type == RESULT)
+    {
+        evaluate_results(&gc2->column_pointer.result, 1);
+    }
+    // a count is the cardinality every result format already carries, positions are never materialized
+    if (agg_type == COUNT)
+    {
+        if (gc2)
+        {
+            send_message->status = INCORRECT_FORMAT;
+            free(result);
+            return;
+        }
+        long *result_data = malloc(1 * sizeof(long));
+        if (gc1->column_type == RESULT)
+        {
+            *result_data = gc1->column_pointer.result->num_tuples;
+        }
+        else
+        {
+            *result_data = gc1->column_pointer.column->length;
             free(gc1);
         }
+        result->data_type = LONG;
+        result->payload = result_data;
+        result->num_tuples = 1;
+        add_context(result, client_context, query->operator_fields.aggregate_operator.intermediate);
+        return;
+    }
+    // bitmap and range positions are aggregated in their encoding, element-wise operators need them as arrays
+    GeneralizedColumn *operand = gc1;
+    if (operand->column_type == RESULT && (operand->column_pointer.result->format == BITMAP || operand->column_pointer.result->format == RANGES))
+    {
+        if (agg_type == SUM || agg_type == AVG || agg_type == MAX || agg_type == MIN)
+        {
+            if (operand->column_pointer.result->format == BITMAP)
+                aggregate_bitmap(operand->column_pointer.result, agg_type, result);
+            else
+                aggregate_ranges(operand->column_pointer.result, agg_type, result);
+            add_context(result, client_context, query->operator_fields.aggregate_operator.intermediate);
+            return;
+        }
+        materialize_result(operand->column_pointer.result);
     }
-    else if (agg_type == ADD || agg_type == SUB)
+    operand = query->operator_fields.aggregate_operator.gc2;
+    if (query->operator_fields.aggregate_operator.variable_number == 2 && operand->column_type == RESULT)
+    {
+        materialize_result(operand->column_pointer.result);
+    }
+    if (agg_type == SUM || agg_type == AVG)
     {
         GeneralizedColumn *gc1 = query->operator_fields.aggregate_operator.gc1;
-        GeneralizedColumn *gc2 = query->operator_fields.aggregate_operator.gc2;
-
         if (gc1->column_type == RESULT)
         {
-            if (gc2->column_type == RESULT)
-            { // RESULT RESULT
-                Result *data1 = gc1->column_pointer.result;
-                Result *data2 = gc2->column_pointer.result;
-                if (data1->num_tuples != data2->num_tuples)
-                {
-                    send_message->status = INCORRECT_FORMAT;
-                    return;
-                }
-                if (data1->data_type == INT)
-                { // int
-                    if (data2->data_type == INT)
-                    { // int int
-                        long *payload = malloc(data1->num_tuples * sizeof(long));
-                        int *payload1 = data1->payload;
-                        int *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = LONG;
-                        result->payload = payload;
-                    }
-                    else if (data2->data_type == LONG)
-                    { // int long
-                        long *payload = malloc(data1->num_tuples * sizeof(long));
-                        int *payload1 = data1->payload;
-                        long *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = LONG;
-                        result->payload = payload;
-                    }
-                    else
-                    { // int= float
-                        float *payload = malloc(data1->num_tuples * sizeof(float));
-                        int *payload1 = data1->payload;
-                        float *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = FLOAT;
-                        result->payload = payload;
-                    }
-                }
-                else if (data1->data_type == LONG)
-                { // long
-                    if (data2->data_type == INT)
-                    { // long int
-                        long *payload = malloc(data1->num_tuples * sizeof(long));
-                        long *payload1 = data1->payload;
-                        int *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = LONG;
-                        result->payload = payload;
-                    }
-                    else if (data2->data_type == LONG)
-                    { // long long
-                        long *payload = malloc(data1->num_tuples * sizeof(long));
-                        long *payload1 = data1->payload;
-                        long *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = LONG;
-                        result->payload = payload;
-                    }
-                    else
-                    { // int/long float
-                        float *payload = malloc(data1->num_tuples * sizeof(float));
-                        long *payload1 = data1->payload;
-                        float *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = FLOAT;
-                        result->payload = payload;
-                    }
-                }
-                else
-                { // float
-                    if (data2->data_type == INT)
-                    { // float int
-                        float *payload = malloc(data1->num_tuples * sizeof(float));
-                        float *payload1 = data1->payload;
-                        int *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = FLOAT;
-                        result->payload = payload;
-                    }
-                    else if (data2->data_type == LONG)
-                    { // float long
-                        float *payload = malloc(data1->num_tuples * sizeof(float));
-                        float *payload1 = data1->payload;
-                        long *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = FLOAT;
-                        result->payload = payload;
-                    }
-                    else
-                    { // float float
-                        float *payload = malloc(data1->num_tuples * sizeof(float));
-                        float *payload1 = data1->payload;
-                        float *payload2 = data2->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                        }
-                        result->num_tuples = data1->num_tuples;
-                        result->data_type = FLOAT;
-                        result->payload = payload;
-                    }
-                }
-            }
-            else
-            { // RESULT COLUMN
-                Result *data1 = gc1->column_pointer.result;
-                Column *data2 = gc2->column_pointer.column;
-                if (data1->num_tuples != data2->length)
-                {
-                    send_message->status = INCORRECT_FORMAT;
-                    return;
-                }
-                if (data1->data_type == INT)
-                { // int int
-                    long *payload = malloc(data1->num_tuples * sizeof(long));
-                    int *payload1 = data1->payload;
-                    int *payload2 = data2->data;
-                    for (size_t i = 0; i < data1->num_tuples; i++)
-                    {
-                        payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                    }
-                    result->num_tuples = data1->num_tuples;
-                    result->data_type = LONG;
-                    result->payload = payload;
-                }
-                else if (data1->data_type == LONG)
-                { // long int
-                    long *payload = malloc(data1->num_tuples * sizeof(long));
-                    long *payload1 = data1->payload;
-                    int *payload2 = data2->data;
-                    for (size_t i = 0; i < data1->num_tuples; i++)
-                    {
-                        payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                    }
-                    result->num_tuples = data1->num_tuples;
-                    result->data_type = LONG;
-                    result->payload = payload;
-                }
-                else
-                { // float int
-                    float *payload = malloc(data1->num_tuples * sizeof(float));
-                    float *payload1 = data1->payload;
-                    int *payload2 = data2->data;
-                    for (size_t i = 0; i < data1->num_tuples; i++)
-                    {
-                        payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                    }
-                    result->num_tuples = data1->num_tuples;
-                    result->data_type = FLOAT;
-                    result->payload = payload;
-                }
-                free(gc2);
-            }
+            aggregate_sum(gc1->column_pointer.result->payload, gc1->column_pointer.result->data_type, gc1->column_pointer.result->num_tuples, agg_type, result);
         }
         else
-        { // COLUMN RESULT
-            if (gc2->column_type == RESULT)
-            {
-                Column *data1 = gc1->column_pointer.column;
-                Result *data2 = gc2->column_pointer.result;
-                if (data1->length != data2->num_tuples)
-                {
-                    send_message->status = INCORRECT_FORMAT;
-                    return;
-                }
-                if (data2->data_type == INT)
-                { // int int
-                    long *payload = malloc(data2->num_tuples * sizeof(long));
-                    int *payload1 = data1->data;
-                    int *payload2 = data2->payload;
-                    for (size_t i = 0; i < data2->num_tuples; i++)
-                    {
-                        payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                    }
-                    result->num_tuples = data2->num_tuples;
-                    result->data_type = LONG;
-                    result->payload = payload;
-                }
-                else if (data2->data_type == LONG)
-                { // int long
-                    long *payload = malloc(data2->num_tuples * sizeof(long));
-                    int *payload1 = data1->data;
-                    long *payload2 = data2->payload;
-                    for (size_t i = 0; i < data2->num_tuples; i++)
-                    {
-                        payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                    }
-                    result->num_tuples = data2->num_tuples;
-                    result->data_type = LONG;
-                    result->payload = payload;
-                }
-                else
-                { // int float
-                    float *payload = malloc(data2->num_tuples * sizeof(float));
-                    int *payload1 = data1->data;
-                    float *payload2 = data2->payload;
-                    for (size_t i = 0; i < data2->num_tuples; i++)
-                    {
-                        payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                    }
-                    result->num_tuples = data2->num_tuples;
-                    result->data_type = FLOAT;
-                    result->payload = payload;
-                }
-                free(gc1);
-            }
-            else
-            { // COLUMN COLUMN
-                Column *data1 = gc1->column_pointer.column;
-                Column *data2 = gc2->column_pointer.column;
-                if (data1->length != data2->length)
-                {
-                    send_message->status = INCORRECT_FORMAT;
-                    return;
-                }
-                // int int
-                long *payload = malloc(data2->length * sizeof(long));
-                int *payload1 = data1->data;
-                int *payload2 = data2->data;
-                for (size_t i = 0; i < data2->length; i++)
-                {
-                    payload[i] = agg_type == ADD ? payload1[i] + payload2[i] : payload1[i] - payload2[i];
-                }
-                result->num_tuples = data2->length;
-                result->data_type = LONG;
-                result->payload = payload;
-                free(gc1);
-                free(gc2);
-            }
+        { // column
+            Column *column = gc1->column_pointer.column;
+            if (!aggregate_column_stats(column, agg_type, result))
+                aggregate_sum(column->data, INT, column->length, agg_type, result);
+            free(gc1);
         }
     }
+    else if (agg_type == ADD || agg_type == SUB || agg_type == MUL || agg_type == DIV || agg_type == NEG)
+    {
+        free(result);
+        execute_arith(query, send_message);
+        return;
+    }
     else if (agg_type == MAX || agg_type == MIN)
     {
         if (query->operator_fields.aggregate_operator.variable_number == 1)
@@ -1208,210 +1349,544 @@ void execute_aggregate(DbOperator *query, message *send_message)
             GeneralizedColumn *gc1 = query->operator_fields.aggregate_operator.gc1;
             if (gc1->column_type == RESULT)
             {
-                Result *data1 = gc1->column_pointer.result;
-                if (data1->data_type == INT)
-                {
-                    int *result_data = malloc(1 * sizeof(int));
-                    if (agg_type == MAX)
-                    {
-                        *result_data = -__INT_MAX__ - 1;
-                        int *payload = data1->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            *result_data = payload[i] > *result_data ? payload[i] : *result_data;
-                        }
-                    }
-                    else
-                    { // M_I_N
-                        *result_data = __INT_MAX__;
-                        int *payload = data1->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            *result_data = payload[i] < *result_data ? payload[i] : *result_data;
-                        }
-                    }
-                    result->data_type = INT;
-                    result->payload = result_data;
-                    result->num_tuples = 1;
-                }
-                else if (data1->data_type == LONG)
-                {
-                    long *result_data = malloc(1 * sizeof(long));
-                    if (agg_type == MAX)
-                    {
-                        *result_data = -__INT_MAX__ - 1;
-                        long *payload = data1->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            *result_data = payload[i] > *result_data ? payload[i] : *result_data;
-                        }
-                    }
-                    else
-                    { // M_I_N
-                        *result_data = __INT_MAX__;
-                        long *payload = data1->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            *result_data = payload[i] < *result_data ? payload[i] : *result_data;
-                        }
-                    }
-                    result->data_type = LONG;
-                    result->payload = result_data;
-                    result->num_tuples = 1;
-                }
-                else
-                { // float
-                    float *result_data = malloc(1 * sizeof(float));
-                    if (agg_type == MAX)
-                    {
-                        *result_data = -__INT_MAX__ - 1;
-                        float *payload = data1->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            *result_data = payload[i] > *result_data ? payload[i] : *result_data;
-                        }
-                    }
-                    else
-                    { // M_I_N
-                        *result_data = __INT_MAX__;
-                        float *payload = data1->payload;
-                        for (size_t i = 0; i < data1->num_tuples; i++)
-                        {
-                            *result_data = payload[i] < *result_data ? payload[i] : *result_data;
-                        }
-                    }
-                    result->data_type = FLOAT;
-                    result->payload = result_data;
-                    result->num_tuples = 1;
-                }
+                aggregate_minmax(gc1->column_pointer.result->payload, gc1->column_pointer.result->data_type, gc1->column_pointer.result->num_tuples, agg_type, result);
             }
             else
             { // COLUMN int
-                Column *data1 = gc1->column_pointer.column;
-                int *result_data = malloc(1 * sizeof(int));
-                if (agg_type == MAX)
-                {
-                    *result_data = -__INT_MAX__ - 1;
-                    int *payload = data1->data;
-                    for (size_t i = 0; i < data1->length; i++)
-                    {
-                        *result_data = payload[i] > *result_data ? payload[i] : *result_data;
-                    }
-                }
-                else
-                { // M_I_N
-                    *result_data = __INT_MAX__;
-                    int *payload = data1->data;
-                    for (size_t i = 0; i < data1->length; i++)
-                    {
-                        *result_data = payload[i] < *result_data ? payload[i] : *result_data;
-                    }
-                }
-                result->data_type = INT;
-                result->payload = result_data;
-                result->num_tuples = 1;
+                Column *column = gc1->column_pointer.column;
+                if (!aggregate_column_stats(column, agg_type, result) && !aggregate_column_index(column, agg_type, result))
+                    aggregate_minmax(column->data, INT, column->length, agg_type, result);
                 free(gc1);
             }
         }
-        else
-        { // 2 generalized columns
+        else
+        { // 2 generalized columns
+        }
+    }
+    else
+    {
+        send_message->status = INCORRECT_FORMAT;
+        free(result);
+        return;
+    }
+    add_context(result, client_context, query->operator_fields.aggregate_operator.intermediate);
+}
+typedef struct FusedPartial
+{
+    long sum;
+    size_t count;
+    int min;
+    int max;
+} FusedPartial;
+
+typedef struct FusedAggregate
+{
+    FusedAggregateOperator *op;
+    FusedPartial *partials;
+} FusedAggregate;
+
+// select, fetch and reduce one morsel, FUSED_VECTOR_SIZE rows at a time
+void fused_aggregate_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    FusedAggregate *fused = (FusedAggregate *)arg;
+    FusedAggregateOperator *op = fused->op;
+    const int *select_data = op->select_column->data;
+    const int *fetch_data = op->fetch_column->data;
+    ZoneMap *zone_map = op->select_column->zone_map;
+    FusedPartial partial = {0, 0, __INT_MAX__, -__INT_MAX__ - 1};
+    size_t positions[FUSED_VECTOR_SIZE];
+    for (size_t vector_start = start; vector_start < end; vector_start += FUSED_VECTOR_SIZE)
+    {
+        size_t vector_end = vector_start + FUSED_VECTOR_SIZE < end ? vector_start + FUSED_VECTOR_SIZE : end;
+        size_t zone = vector_start / ZONE_SIZE;
+        if (zone_map && (zone_map->max[zone] < op->low || zone_map->min[zone] > op->high))
+            continue;
+        if (zone_map && zone_map->min[zone] >= op->low && zone_map->max[zone] <= op->high)
+        {
+            // every row qualifies: reduce the fetched slice directly
+            for (size_t i = vector_start; i < vector_end; i++)
+            {
+                partial.sum += fetch_data[i];
+                partial.min = fetch_data[i] < partial.min ? fetch_data[i] : partial.min;
+                partial.max = fetch_data[i] > partial.max ? fetch_data[i] : partial.max;
+            }
+            partial.count += vector_end - vector_start;
+            continue;
+        }
+        size_t matches = select_range(select_data, vector_start, vector_end, op->low, op->high, positions);
+        for (size_t i = 0; i < matches; i++)
+        {
+            int value = fetch_data[positions[i]];
+            partial.sum += value;
+            partial.min = value < partial.min ? value : partial.min;
+            partial.max = value > partial.max ? value : partial.max;
+        }
+        partial.count += matches;
+    }
+    fused->partials[morsel] = partial;
+}
+
+/*
+ * COUNT of an indexed select, or MIN/MAX of the selected values themselves, read off
+ * the index bounds of [low, high] in O(log n); false when the index cannot answer
+ */
+bool index_aggregate(FusedAggregateOperator *op, Result *result)
+{
+    const int *values = index_values(op->select_column);
+    bool self = op->fetch_column == op->select_column;
+    if (!values || !(op->aggregate_type == COUNT || (self && (op->aggregate_type == MIN || op->aggregate_type == MAX))))
+        return false;
+    size_t length = op->select_column->length;
+    size_t index_low = lower_bound_index(values, length, op->low);
+    size_t index_high = lower_bound_index(values, length, (long)op->high + 1);
+    if (index_high < index_low)
+        index_high = index_low;
+    if (op->aggregate_type == COUNT)
+    {
+        long *result_data = malloc(1 * sizeof(long));
+        *result_data = index_high - index_low;
+        result->data_type = LONG;
+        result->payload = result_data;
+    }
+    else
+    {
+        int *result_data = malloc(1 * sizeof(int));
+        if (index_high == index_low)
+            *result_data = op->aggregate_type == MIN ? __INT_MAX__ : -__INT_MAX__ - 1;
+        else
+            *result_data = op->aggregate_type == MIN ? values[index_low] : values[index_high - 1];
+        result->data_type = INT;
+        result->payload = result_data;
+    }
+    return true;
+}
+
+void execute_fused_aggregate(DbOperator *query, message *send_message)
+{
+    FusedAggregateOperator *op = &query->operator_fields.fused_aggregate_operator;
+    Result *result = malloc(sizeof(Result));
+    result->format = MATERIALIZED;
+    result->num_tuples = 1;
+    if (index_aggregate(op, result))
+    {
+        add_context(result, query->context, op->intermediate);
+        send_message->status = OK_DONE;
+        return;
+    }
+    size_t morsels = num_morsels(op->column_length, MORSEL_SIZE);
+    FusedAggregate fused = {op, malloc(morsels * sizeof(FusedPartial))};
+    run_morsels(op->column_length, MORSEL_SIZE, &fused_aggregate_morsel, &fused);
+    FusedPartial total = {0, 0, __INT_MAX__, -__INT_MAX__ - 1};
+    for (size_t m = 0; m < morsels; m++)
+    {
+        total.sum += fused.partials[m].sum;
+        total.count += fused.partials[m].count;
+        total.min = fused.partials[m].min < total.min ? fused.partials[m].min : total.min;
+        total.max = fused.partials[m].max > total.max ? fused.partials[m].max : total.max;
+    }
+    free(fused.partials);
+
+    // same result types as the unfused aggregate over an INT fetch result
+    if (op->aggregate_type == COUNT)
+    {
+        long *result_data = malloc(1 * sizeof(long));
+        *result_data = total.count;
+        result->data_type = LONG;
+        result->payload = result_data;
+    }
+    else if (op->aggregate_type == AVG)
+    {
+        double *result_data = malloc(1 * sizeof(double));
+        *result_data = total.count != 0 ? total.sum * 1.0 / total.count : 0;
+        result->data_type = DOUBLE;
+        result->payload = result_data;
+    }
+    else if (op->aggregate_type == SUM)
+    {
+        long *result_data = malloc(1 * sizeof(long));
+        *result_data = total.sum;
+        result->data_type = LONG;
+        result->payload = result_data;
+    }
+    else
+    {
+        int *result_data = malloc(1 * sizeof(int));
+        *result_data = op->aggregate_type == MIN ? total.min : total.max;
+        result->data_type = INT;
+        result->payload = result_data;
+    }
+    add_context(result, query->context, op->intermediate);
+    send_message->status = OK_DONE;
+}
+
+// values of a group_by operand as a plain array
+static const void *group_operand(GeneralizedColumn *operand, DataType *data_type, size_t *length)
+{
+    if (operand->column_type == COLUMN)
+    {
+        *data_type = INT;
+        *length = operand->column_pointer.column->length;
+        return operand->column_pointer.column->data;
+    }
+    materialize_result(operand->column_pointer.result);
+    *data_type = operand->column_pointer.result->data_type;
+    *length = operand->column_pointer.result->num_tuples;
+    return operand->column_pointer.result->payload;
+}
+
+void execute_group_by(DbOperator *query, message *send_message)
+{
+    GroupByOperator *op = &query->operator_fields.group_by_operator;
+    DataType key_type, value_type;
+    size_t num_keys, num_values;
+    const void *keys = group_operand(op->keys, &key_type, &num_keys);
+    const void *values = group_operand(op->values, &value_type, &num_values);
+    // a clustered column is kept in value order, its groups are runs
+    bool sorted = op->keys->column_type == COLUMN && op->keys->column_pointer.column->clustered;
+    if (op->keys->column_type == COLUMN)
+        free(op->keys);
+    if (op->values->column_type == COLUMN)
+        free(op->values);
+    if (num_keys != num_values || (key_type != INT && key_type != LONG))
+    {
+        send_message->status = INCORRECT_FORMAT;
+        return;
+    }
+    GroupEntry *groups;
+    size_t num_groups = group_by(keys, key_type, values, value_type, num_keys, sorted, &groups);
+    bool floating = value_type == FLOAT || value_type == DOUBLE;
+
+    Result *key_result = malloc(sizeof(Result));
+    key_result->format = MATERIALIZED;
+    key_result->data_type = key_type;
+    key_result->num_tuples = num_groups;
+    key_result->payload = malloc((num_groups > 0 ? num_groups : 1) * (key_type == INT ? sizeof(int) : sizeof(long)));
+    // same result types as the whole-vector aggregate of the values
+    Result *aggregate_result = malloc(sizeof(Result));
+    aggregate_result->format = MATERIALIZED;
+    aggregate_result->num_tuples = num_groups;
+    if (op->aggregate_type == AVG)
+        aggregate_result->data_type = DOUBLE;
+    else if (op->aggregate_type == SUM)
+        aggregate_result->data_type = floating ? DOUBLE : LONG;
+    else
+        aggregate_result->data_type = value_type;
+    size_t width = aggregate_result->data_type == INT ? sizeof(int) : aggregate_result->data_type == FLOAT ? sizeof(float) : sizeof(long);
+    aggregate_result->payload = malloc((num_groups > 0 ? num_groups : 1) * width);
+    for (size_t g = 0; g < num_groups; g++)
+    {
+        if (key_type == INT)
+            ((int *)key_result->payload)[g] = groups[g].key;
+        else
+            ((long *)key_result->payload)[g] = groups[g].key;
+        if (op->aggregate_type == AVG)
+        {
+            double sum = floating ? groups[g].sum.f : groups[g].sum.i;
+            ((double *)aggregate_result->payload)[g] = sum / groups[g].count;
+            continue;
+        }
+        GroupValue value = op->aggregate_type == SUM ? groups[g].sum : op->aggregate_type == MIN ? groups[g].min : groups[g].max;
+        if (aggregate_result->data_type == INT)
+            ((int *)aggregate_result->payload)[g] = value.i;
+        else if (aggregate_result->data_type == LONG)
+            ((long *)aggregate_result->payload)[g] = value.i;
+        else if (aggregate_result->data_type == FLOAT)
+            ((float *)aggregate_result->payload)[g] = value.f;
+        else
+            ((double *)aggregate_result->payload)[g] = value.f;
+    }
+    free(groups);
+    add_context(key_result, query->context, op->keys_name);
+    add_context(aggregate_result, query->context, op->aggregates_name);
+    send_message->status = OK_DONE;
+}
+
+typedef struct MultiSelect
+{
+    const ColumnPredicate *predicates;
+    size_t num_predicates;
+    size_t *positions; // AND: survivors of the driving predicate, filtered in place
+    size_t *counts;
+    MorselPositions outputs; // OR: positions selected by every morsel
+} MultiSelect;
+
+// AND: keeps the survivors whose rows satisfy every remaining predicate, each morsel compacting its own slice
+void conjunction_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MultiSelect *select = (MultiSelect *)arg;
+    size_t *positions = select->positions;
+    size_t k = start;
+    for (size_t i = start; i < end; i++)
+    {
+        size_t position = positions[i];
+        bool match = true;
+        for (size_t p = 0; p < select->num_predicates && match; p++)
+        {
+            int value = select->predicates[p].column->data[position];
+            match = value >= select->predicates[p].low && value <= select->predicates[p].high;
+        }
+        positions[k] = position;
+        k += match;
+    }
+    select->counts[morsel] = k - start;
+}
+
+// OR: positions of the rows satisfying any predicate, zone by zone with the predicates that can match there
+void disjunction_morsel(void *arg, size_t morsel, size_t start, size_t end)
+{
+    MultiSelect *select = (MultiSelect *)arg;
+    size_t *out = acquire_chunk();
+    size_t k = 0;
+    for (size_t zone_start = start; zone_start < end; zone_start += ZONE_SIZE)
+    {
+        size_t zone_end = zone_start + ZONE_SIZE < end ? zone_start + ZONE_SIZE : end;
+        size_t zone = zone_start / ZONE_SIZE;
+        const ColumnPredicate *active[MAX_SELECT_PREDICATES];
+        size_t num_active = 0;
+        bool whole_zone = false;
+        for (size_t p = 0; p < select->num_predicates && !whole_zone; p++)
+        {
+            const ColumnPredicate *predicate = &select->predicates[p];
+            ZoneMap *zone_map = predicate->column->zone_map;
+            if (zone_map && zone < zone_map->num_zones)
+            {
+                if (zone_map->max[zone] < predicate->low || zone_map->min[zone] > predicate->high)
+                    continue;
+                whole_zone = zone_map->min[zone] >= predicate->low && zone_map->max[zone] <= predicate->high;
+            }
+            active[num_active++] = predicate;
+        }
+        for (size_t i = zone_start; i < zone_end && (whole_zone || num_active); i++)
+        {
+            bool match = whole_zone;
+            for (size_t p = 0; p < num_active && !match; p++)
+            {
+                int value = active[p]->column->data[i];
+                match = value >= active[p]->low && value <= active[p]->high;
+            }
+            out[k] = i;
+            k += match;
+        }
+    }
+    morsel_positions_keep(&select->outputs, morsel, out, k);
+}
+
+void execute_multi_select(DbOperator *query, message *send_message)
+{
+    MultiSelectOperator *op = &query->operator_fields.multi_select_operator;
+    ColumnPredicate predicates[MAX_SELECT_PREDICATES];
+    double selectivity[MAX_SELECT_PREDICATES];
+    // AND runs the most selective predicate first, OR the least selective, so the inner loops stop earliest
+    for (size_t i = 0; i < op->num_predicates; i++)
+    {
+        ColumnPredicate predicate = op->predicates[i];
+        double estimate = estimate_selectivity(predicate.column, predicate.low, predicate.high);
+        size_t j = i;
+        for (; j > 0 && (op->disjunctive ? selectivity[j - 1] < estimate : selectivity[j - 1] > estimate); j--)
+        {
+            predicates[j] = predicates[j - 1];
+            selectivity[j] = selectivity[j - 1];
         }
+        predicates[j] = predicate;
+        selectivity[j] = estimate;
+    }
+
+    Result *result;
+    if (op->disjunctive)
+    {
+        MultiSelect select = {predicates, op->num_predicates, NULL, NULL, {NULL, NULL, 0}};
+        morsel_positions_init(&select.outputs, op->column_length);
+        run_morsels(op->column_length, MORSEL_SIZE, &disjunction_morsel, &select);
+        PositionBuffer buffer;
+        position_buffer_init(&buffer, 0);
+        result = malloc(sizeof(Result));
+        result->format = MATERIALIZED;
+        result->data_type = LONG;
+        result->num_tuples = morsel_positions_gather(&select.outputs, &buffer);
+        result->payload = position_buffer_finish(&buffer);
     }
     else
     {
-        send_message->status = INCORRECT_FORMAT;
-        free(result);
-        return;
+        // the driving predicate goes through its column's index when there is one
+        result = select_column(predicates[0].column, op->column_length, predicates[0].low, predicates[0].high);
+        if (op->num_predicates > 1)
+        {
+            materialize_result(result);
+            size_t morsels = num_morsels(result->num_tuples, MORSEL_SIZE);
+            MultiSelect select = {predicates + 1, op->num_predicates - 1, result->payload, malloc(morsels * sizeof(size_t)), {NULL, NULL, 0}};
+            run_morsels(result->num_tuples, MORSEL_SIZE, &conjunction_morsel, &select);
+            size_t index = 0;
+            for (size_t m = 0; m < morsels; m++)
+            {
+                memmove(select.positions + index, select.positions + m * MORSEL_SIZE, select.counts[m] * sizeof(size_t));
+                index += select.counts[m];
+            }
+            free(select.counts);
+            result->num_tuples = index;
+        }
     }
-    add_context(result, client_context, query->operator_fields.aggregate_operator.intermediate);
+    add_context(result, query->context, op->intermediate);
+    send_message->status = OK_DONE;
 }
-void grace_hash_join_partition(void *args)
+
+static int position_cmp(const void *a, const void *b)
 {
-    thread_args *arguments = (thread_args *)args;
-    for (size_t j = 0; j < arguments->len; j++)
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+    return (x > y) - (x < y);
+}
+
+// ascending positions of a materialized positions result, copied and sorted when they are not already
+static size_t *sorted_positions(Result *result, bool *copied)
+{
+    size_t *positions = result->payload;
+    *copied = !positions_sorted(positions, result->num_tuples);
+    if (*copied)
     {
-        int index_p = arguments->column[j] / arguments->p_div;
-        arguments->partitions[index_p].values[arguments->partitions[index_p].p_len] = arguments->column[j];
-        arguments->partitions[index_p].positions[arguments->partitions[index_p].p_len] = arguments->pos[j];
-        arguments->partitions[index_p].p_len++;
-        if (arguments->partitions[index_p].p_len >= arguments->partitions[index_p].p_capacity)
-        {
-            // reallocate and increment size by twice
-            arguments->partitions[index_p].p_capacity *= 2;
-            arguments->partitions[index_p].values = realloc(arguments->partitions[index_p].values, arguments->partitions[index_p].p_capacity * sizeof(int));
-            arguments->partitions[index_p].positions = realloc(arguments->partitions[index_p].positions, arguments->partitions[index_p].p_capacity * sizeof(size_t));
-        }
+        positions = malloc(result->num_tuples * sizeof(size_t));
+        memcpy(positions, result->payload, result->num_tuples * sizeof(size_t));
+        qsort(positions, result->num_tuples, sizeof(size_t), position_cmp);
     }
-    pthread_mutex_lock(&lock);
-    // record the number of successful tasks completed
-    done++;
-    pthread_mutex_unlock(&lock);
-    // free arguments
-    free(arguments);
+    return positions;
 }
-void grace_hash_join(void *args)
+
+void execute_position_set(DbOperator *query, message *send_message)
 {
-    thread_args *arguments = (thread_args *)args;
-    if (arguments->partitionR->p_len * arguments->partitionL->p_len == 0) {
-        pthread_mutex_lock(&lock);
-        // record the number of successful tasks completed
-        done++;
-        pthread_mutex_unlock(&lock);
-        // free arguments
-        free(arguments);
+    PositionSetOperator *op = &query->operator_fields.position_set_operator;
+    GeneralizedColumn *gc1 = lookup_variables(NULL, NULL, NULL, op->left, query->context);
+    GeneralizedColumn *gc2 = lookup_variables(NULL, NULL, NULL, op->right, query->context);
+    if (!gc1 || !gc2 || gc1->column_type != RESULT || gc2->column_type != RESULT)
+    {
+        send_message->status = OBJECT_NOT_FOUND;
         return;
     }
-    // always hash on the small column
-    hashtable *ht = malloc(sizeof(struct hashtable));
-    // compare and swap
-    if (arguments->partitionR->p_len <= arguments->partitionL->p_len)
+    Result *operands[2] = {gc1->column_pointer.result, gc2->column_pointer.result};
+    evaluate_results(operands, 2);
+    for (int i = 0; i < 2; i++)
+    {
+        if (operands[i]->data_type != LONG)
+        {
+            send_message->status = INCORRECT_FORMAT;
+            return;
+        }
+        // bitmaps are combined as they are, everything else as position lists
+        if (operands[i]->format != BITMAP)
+        {
+            materialize_result(operands[i]);
+        }
+    }
+    // keep the bitmap, if any, on the left
+    if (operands[1]->format == BITMAP && operands[0]->format != BITMAP)
+    {
+        Result *swap = operands[0];
+        operands[0] = operands[1];
+        operands[1] = swap;
+    }
+    Result *left = operands[0];
+    Result *right = operands[1];
+
+    Result *result = malloc(sizeof(Result));
+    result->format = MATERIALIZED;
+    result->data_type = LONG;
+    if (left->format == BITMAP && right->format == BITMAP && left->num_rows == right->num_rows)
+    {
+        // word-wise and/or of the two bitmaps
+        uint64_t *bits = malloc(bitmap_words(left->num_rows) * sizeof(uint64_t));
+        if (op->disjunctive)
+        {
+            result->num_tuples = bitmap_or(left->payload, right->payload, left->num_rows, bits);
+        }
+        else
+        {
+            result->num_tuples = bitmap_and(left->payload, right->payload, left->num_rows, bits);
+        }
+        result->format = BITMAP;
+        result->num_rows = left->num_rows;
+        result->payload = bits;
+    }
+    else if (left->format == BITMAP && right->format != BITMAP)
     {
-        size_t res[arguments->partitionR->p_len];
-        allocate_ht(ht, arguments->partitionR->p_len);
-        for (size_t j = 0; j < arguments->partitionR->p_len; j++)
+        const uint64_t *bits = left->payload;
+        const size_t *positions = right->payload;
+        if (op->disjunctive)
         {
-            put_ht(ht, arguments->partitionR->values[j], arguments->partitionR->positions[j]);
+            // set the list's bits in a copy of the bitmap
+            size_t num_rows = left->num_rows;
+            for (size_t i = 0; i < right->num_tuples; i++)
+            {
+                num_rows = positions[i] >= num_rows ? positions[i] + 1 : num_rows;
+            }
+            size_t num_words = bitmap_words(num_rows);
+            uint64_t *out = calloc(num_words, sizeof(uint64_t));
+            memcpy(out, bits, bitmap_words(left->num_rows) * sizeof(uint64_t));
+            for (size_t i = 0; i < right->num_tuples; i++)
+            {
+                out[positions[i] / 64] |= (uint64_t)1 << (positions[i] % 64);
+            }
+            size_t count = 0;
+            for (size_t w = 0; w < num_words; w++)
+            {
+                count += __builtin_popcountll(out[w]);
+            }
+            result->format = BITMAP;
+            result->num_rows = num_rows;
+            result->num_tuples = count;
+            result->payload = out;
         }
-        for (size_t t = 0; t < arguments->partitionL->p_len; t++)
+        else
         {
-            size_t res_len = get_ht(ht, arguments->partitionL->values[t], res);
-            for (size_t j = 0; j < res_len; j++)
+            // probe the bitmap for every position of the list, order is kept
+            size_t *out = malloc(right->num_tuples * sizeof(size_t));
+            size_t index = 0;
+            for (size_t i = 0; i < right->num_tuples; i++)
             {
-                pthread_mutex_lock(&grace_hash_lock);
-                arguments->resL[mutex_k] = arguments->partitionL->positions[t];
-                arguments->resR[mutex_k++] = res[j];
-                pthread_mutex_unlock(&grace_hash_lock);
+                size_t p = positions[i];
+                out[index] = p;
+                index += p < left->num_rows && ((bits[p / 64] >> (p % 64)) & 1);
             }
+            result->num_tuples = index;
+            result->payload = out;
         }
     }
     else
     {
-        size_t res[arguments->partitionL->p_len];
-        allocate_ht(ht, arguments->partitionL->p_len);
-        for (size_t j = 0; j < arguments->partitionL->p_len; j++)
+        if (left->format == BITMAP)
         {
-            put_ht(ht, arguments->partitionL->values[j], arguments->partitionL->positions[j]);
+            // bitmaps over different row counts
+            materialize_result(left);
+            materialize_result(right);
         }
-        for (size_t t = 0; t < arguments->partitionR->p_len; t++)
+        bool left_copied, right_copied;
+        size_t *a = sorted_positions(left, &left_copied);
+        size_t *b = sorted_positions(right, &right_copied);
+        size_t na = left->num_tuples;
+        size_t nb = right->num_tuples;
+        bool parallel = na >= PARALLEL_SELECT_THRESHOLD && nb >= PARALLEL_SELECT_THRESHOLD;
+        size_t *out;
+        if (op->disjunctive)
         {
-            size_t res_len = get_ht(ht, arguments->partitionR->values[t], res);
-            for (size_t j = 0; j < res_len; j++)
-            {
-                pthread_mutex_lock(&grace_hash_lock);
-                arguments->resR[mutex_k] = arguments->partitionR->positions[t];
-                arguments->resL[mutex_k++] = res[j];
-                pthread_mutex_unlock(&grace_hash_lock);
-            }
+            out = malloc((na + nb) * sizeof(size_t));
+            result->num_tuples = parallel ? parallel_union_positions(a, na, b, nb, out) : union_positions(a, na, b, nb, out);
+        }
+        else
+        {
+            out = malloc((na < nb ? na : nb) * sizeof(size_t));
+            result->num_tuples = parallel ? parallel_intersect_positions(a, na, b, nb, out) : intersect_positions(a, na, b, nb, out);
+        }
+        result->payload = out;
+        if (left_copied)
+        {
+            free(a);
+        }
+        if (right_copied)
+        {
+            free(b);
         }
     }
-    deallocate_ht(ht);
-    pthread_mutex_lock(&lock);
-    // record the number of successful tasks completed
-    done++;
-    pthread_mutex_unlock(&lock);
-    // free arguments
-    free(arguments);
+    add_context(result, query->context, op->intermediate);
+    send_message->status = OK_DONE;
 }
+
 void execute_join(DbOperator *query, message *send_message)
 {
     ClientContext *client_context = query->context;
@@ -1419,6 +1894,9 @@ void execute_join(DbOperator *query, message *send_message)
     Result *f2 = query->operator_fields.join_operator.f2;
     Result *p1 = query->operator_fields.join_operator.p1;
     Result *p2 = query->operator_fields.join_operator.p2;
+    // the join walks positions and values by index
+    Result *operands[4] = {f1, p1, f2, p2};
+    materialize_results(operands, 4);
 
     int *L = (int *)f1->payload;
     int *R = (int *)f2->payload;
@@ -1426,11 +1904,27 @@ void execute_join(DbOperator *query, message *send_message)
     size_t *posR = (size_t *)p2->payload;
     size_t lenL = p1->num_tuples;
     size_t lenR = p2->num_tuples;
-    size_t *resL = malloc(lenR * lenL * sizeof(size_t));
-    size_t *resR = malloc(lenR * lenL * sizeof(size_t));
-    size_t k = 0;
-    mutex_k = 0;
-    if (query->operator_fields.join_operator.joinType == NESTED_LOOP_JOIN)
+    // the output is sized from value histograms of both sides instead of lenL * lenR, the buffers grow past that
+    JoinHistogram *histogram = malloc(sizeof(JoinHistogram));
+    join_histogram(L, lenL, R, lenR, histogram);
+    // the radix join sizes its own outputs per partition
+    PositionBuffer resL, resR;
+    if (histogram->empty)
+    {
+        position_buffer_init(&resL, 0);
+        position_buffer_init(&resR, 0);
+    }
+    else if (query->operator_fields.join_operator.joinType == NESTED_LOOP_JOIN || lenL <= CACHE_SIZE_THRESHOLD || lenR <= CACHE_SIZE_THRESHOLD)
+    {
+        size_t estimate = estimate_join_size(histogram, 0, JOIN_HISTOGRAM_BUCKETS);
+        position_buffer_init(&resL, estimate);
+        position_buffer_init(&resR, estimate);
+    }
+    if (histogram->empty)
+    {
+        // no value of one side lies in the range of the other
+    }
+    else if (query->operator_fields.join_operator.joinType == NESTED_LOOP_JOIN)
     {
 
         for (size_t i = 0; i < lenL; i++)
@@ -1439,8 +1933,8 @@ void execute_join(DbOperator *query, message *send_message)
             {
                 if (L[i] == R[j])
                 {
-                    resL[k] = posL[i];
-                    resR[k++] = posR[j];
+                    position_buffer_append(&resL, &posL[i], 1);
+                    position_buffer_append(&resR, &posR[j], 1);
                 }
             }
         }
@@ -1450,180 +1944,37 @@ void execute_join(DbOperator *query, message *send_message)
         if (lenL <= CACHE_SIZE_THRESHOLD || lenR <= CACHE_SIZE_THRESHOLD)
         {
             // always hash on the small column
-            hashtable *ht = malloc(sizeof(struct hashtable));
-            // compare and swap
+            JoinTable table;
             if (lenR <= lenL)
             {
-                size_t res[lenR];
-                allocate_ht(ht, lenR);
-                for (size_t j = 0; j < lenR; j++)
-                {
-                    put_ht(ht, R[j], posR[j]);
-                }
-                for (size_t i = 0; i < lenL; i++)
-                {
-                    size_t res_len = get_ht(ht, L[i], res);
-                    for (size_t j = 0; j < res_len; j++)
-                    {
-                        resL[k] = posL[i];
-                        resR[k++] = res[j];
-                    }
-                }
+                join_table_init(&table, lenR);
+                hash_join(&table, R, posR, lenR, L, posL, lenL, &resR, &resL);
             }
             else
             {
-                size_t res[lenL];
-                allocate_ht(ht, lenL);
-                for (size_t j = 0; j < lenL; j++)
-                {
-                    put_ht(ht, L[j], posL[j]);
-                }
-                for (size_t i = 0; i < lenR; i++)
-                {
-                    size_t res_len = get_ht(ht, R[i], res);
-                    for (size_t j = 0; j < res_len; j++)
-                    {
-                        resR[k] = posR[i];
-                        resL[k++] = res[j];
-                    }
-                }
+                join_table_init(&table, lenL);
+                hash_join(&table, L, posL, lenL, R, posR, lenR, &resL, &resR);
             }
-            deallocate_ht(ht);
+            join_table_free(&table);
         }
         else
         {
-            // GRACE HASH JOIN
-            // 1. find ranges
-            // find max value in L
-            int max;
-            max = L[0];
-            for (size_t t = 1; t < lenL; t++)
-
-            {
-                if (L[t] > max)
-                    max = L[t];
-            }
-            int p_div = max / (NUM_PARTITIONS - 1); // #_p = value / p_div
-            size_t capacity = lenL / NUM_PARTITIONS;
-            // TODO: free partitions
-            Partition *partitionsL = malloc(NUM_PARTITIONS * sizeof(Partition));
-            Partition *partitionsR = malloc(NUM_PARTITIONS * sizeof(Partition));
-            for (int i = 0; i < NUM_PARTITIONS; i++)
-            {
-                partitionsL[i].p_capacity = capacity;
-                partitionsL[i].p_len = 0;
-                partitionsL[i].values = malloc(capacity * sizeof(int));
-                partitionsL[i].positions = malloc(capacity * sizeof(size_t));
-                partitionsR[i].p_capacity = capacity;
-                partitionsR[i].p_len = 0;
-                partitionsR[i].values = malloc(capacity * sizeof(int));
-                partitionsR[i].positions = malloc(capacity * sizeof(size_t));
-            }
-
-            // 2. build partitions
-            tasks = 0;
-            done = 0;
-            pthread_mutex_init(&lock, NULL);
-            if ((pool = threadpool_create(2, QUEUE, 0)) == NULL)
-            {
-                send_message->status = EXECUTION_ERROR;
-                return;
-            }
-            thread_args *argsL = malloc(sizeof(thread_args));
-            argsL->partitions = partitionsL;
-            argsL->len = lenL;
-            argsL->column = L;
-            argsL->p_div = p_div;
-            argsL->pos = posL;
-            argsL->send_message = send_message;
-            while (tasks - done >= THREAD)
-            {
-                sleep(0.01);
-            }
-            if (threadpool_add(pool, &grace_hash_join_partition, (void *)argsL, 0) == 0)
-            {
-                pthread_mutex_lock(&lock);
-                tasks++;
-                pthread_mutex_unlock(&lock);
-            }
-            else
-            {
-                cs165_log(stdout, "Start pool failed\n");
-                send_message->status = EXECUTION_ERROR;
-                return;
-            }
-            thread_args *argsR = malloc(sizeof(thread_args));
-            argsR->partitions = partitionsR;
-            argsR->len = lenR;
-            argsR->column = R;
-            argsR->p_div = p_div;
-            argsR->pos = posR;
-            argsR->send_message = send_message;
-            if (threadpool_add(pool, &grace_hash_join_partition, (void *)argsR, 0) == 0)
-            {
-                pthread_mutex_lock(&lock);
-                tasks++;
-                pthread_mutex_unlock(&lock);
-            }
-            else
-            {
-                cs165_log(stdout, "Start pool failed\n");
-                send_message->status = EXECUTION_ERROR;
-                return;
-            }
-
-            while (tasks > done)
-            {
-                sleep(0.01);
-            }
-            pthread_mutex_init(&grace_hash_lock, NULL);
-
-            for (int i = 0; i < NUM_PARTITIONS; i++)
-            {
-                thread_args *args = malloc(sizeof(thread_args));
-                args->partitionR = &partitionsR[i];
-                args->partitionL = &partitionsL[i];
-                args->resR = resR;
-                args->resL = resL;
-
-                if (threadpool_add(pool, &grace_hash_join, (void *)args, 0) == 0)
-                {
-                    pthread_mutex_lock(&lock);
-                    tasks++;
-                    pthread_mutex_unlock(&lock);
-                }
-                else
-                {
-                    cs165_log(stdout, "Start pool failed\n");
-                    send_message->status = EXECUTION_ERROR;
-                    return;
-                }
-            }
-            while (tasks > done)
-            {
-                sleep(0.01); // TODO: change sleep time
-            }
-            k = mutex_k;
-            // At this point, destroy the thread pool, 0 for immediate_shutdown
-            if (threadpool_destroy(pool, 0) != 0)
-            {
-                cs165_log(stdout, "Destroy pool failed\n");
-                send_message->status = EXECUTION_ERROR; // TODO: check how to deal with pool destruction error
-                return;
-            }
-            pthread_mutex_destroy(&grace_hash_lock);
-            pthread_mutex_destroy(&lock);
+            // RADIX HASH JOIN
+            radix_join(L, posL, lenL, R, posR, lenR, histogram, &resL, &resR);
         }
     }
+    free(histogram);
     Result *resultL = malloc(sizeof(Result));
+    resultL->format = MATERIALIZED;
     resultL->data_type = LONG;
-    resultL->num_tuples = k;
-    resultL->payload = resL;
+    resultL->num_tuples = resL.length;
+    resultL->payload = position_buffer_finish(&resL);
     add_context(resultL, client_context, query->operator_fields.join_operator.l_name);
     Result *resultR = malloc(sizeof(Result));
+    resultR->format = MATERIALIZED;
     resultR->data_type = LONG;
-    resultR->num_tuples = k;
-    resultR->payload = resR;
+    resultR->num_tuples = resR.length;
+    resultR->payload = position_buffer_finish(&resR);
     add_context(resultR, client_context, query->operator_fields.join_operator.r_name);
 
     send_message->status = OK_DONE;
@@ -1644,6 +1995,7 @@ void execute_print(DbOperator *query, message *send_message)
         GeneralizedColumn *generalized_column = lookup_variables(NULL, NULL, NULL, intermediate, client_context);
         results[j] = generalized_column->column_pointer.result;
     }
+    materialize_results(results, query->operator_fields.print_operator.number_intermediates);
     print_len = results[0]->num_tuples;
 
     char *print_chars = malloc(32 * query->operator_fields.print_operator.number_intermediates * print_len * sizeof(char));
@@ -1731,39 +2083,247 @@ void execute_batch_start(ClientContext *client_context, message *send_message)
     }
 
     // allocate size in client context to store db operators
-    // client_context->batch_queries = malloc(HANDLE_MAX_SIZE * sizeof(DbOperator*));
+    client_context->batch_capacity = HANDLE_MAX_SIZE;
+    client_context->num_batch_queries = 0;
+    client_context->batch_queries = malloc(client_context->batch_capacity * sizeof(DbOperator *));
     send_message->status = OK_DONE;
 }
 
 // server: Thread pool, take query on the fly
 //      queue for clients (bonus)
 // client: ClientContext
-void execute_batch_select(DbOperator *query, message *send_message)
+void execute_batch_query(DbOperator *query, message *send_message)
 {
-    thread_args *args = malloc(sizeof(thread_args));
-    args->query = query;
-    args->send_message = send_message;
-    if (threadpool_add(pool, &batch_execute_select, (void *)args, 0) == 0)
+    // selects and fetches are only queued here, batch_execute groups the selects by column and scans
+    // each column once, and merges consecutive fetches of the same positions
+    ClientContext *client_context = query->context;
+    if (client_context->num_batch_queries == client_context->batch_capacity)
     {
-        pthread_mutex_lock(&lock);
-        tasks++;
-        pthread_mutex_unlock(&lock);
+        client_context->batch_capacity *= 2;
+        client_context->batch_queries = realloc(client_context->batch_queries, client_context->batch_capacity * sizeof(DbOperator *));
     }
-    else
+    client_context->batch_queries[client_context->num_batch_queries++] = query;
+    send_message->status = BATCH_WAIT;
+}
+
+// one cache-blocked pass over a column that checks every batched predicate on that column
+void batch_shared_scan(void *args)
+{
+    thread_args *arguments = (thread_args *)args;
+    DbOperator **queries = arguments->queries;
+    size_t num_queries = arguments->num_queries;
+    Column *column = queries[0]->operator_fields.select_operator.column;
+    size_t column_length = queries[0]->operator_fields.select_operator.column_length;
+    const int *zone_min = column->zone_map ? column->zone_map->min : NULL;
+    const int *zone_max = column->zone_map ? column->zone_map->max : NULL;
+
+    // position outputs start from their estimated size, so a batch of selective queries stays small
+    PositionBuffer *select_data = malloc(num_queries * sizeof(PositionBuffer));
+    uint64_t **select_bits = malloc(num_queries * sizeof(uint64_t *));
+    size_t *index = malloc(num_queries * sizeof(size_t));
+    for (size_t q = 0; q < num_queries; q++)
     {
-        cs165_log(stdout, "Start pool failed\n");
-        send_message->status = EXECUTION_ERROR;
-        return;
+        SelectOperator *select_operator = &queries[q]->operator_fields.select_operator;
+        select_bits[q] = NULL;
+        if (choose_position_format(column, select_operator->low, select_operator->high) == BITMAP)
+            select_bits[q] = malloc(bitmap_words(column_length) * sizeof(uint64_t));
+        else
+            position_buffer_init(&select_data[q], estimate_selectivity(column, select_operator->low, select_operator->high) * column_length);
+        index[q] = 0;
     }
-    send_message->status = BATCH_WAIT;
+    for (size_t start = 0; start < column_length; start += SHARED_SCAN_CHUNK)
+    {
+        size_t end = start + SHARED_SCAN_CHUNK < column_length ? start + SHARED_SCAN_CHUNK : column_length;
+        // the chunk stays L1-resident while every predicate is checked against it
+        for (size_t q = 0; q < num_queries; q++)
+        {
+            SelectOperator *select_operator = &queries[q]->operator_fields.select_operator;
+            if (select_bits[q])
+                index[q] += select_bitmap_zoned(column->data, start, end, zone_min, zone_max, select_operator->low, select_operator->high, select_bits[q]);
+            else
+            {
+                size_t *out = position_buffer_reserve(&select_data[q], end - start);
+                select_data[q].length += select_range_zoned(column->data, start, end, zone_min, zone_max, select_operator->low, select_operator->high, out);
+                index[q] = select_data[q].length;
+            }
+        }
+    }
+    for (size_t q = 0; q < num_queries; q++)
+    {
+        Result *result = malloc(sizeof(Result));
+        result->data_type = LONG;
+        result->num_tuples = index[q];
+        if (select_bits[q])
+        {
+            result->format = BITMAP;
+            result->num_rows = column_length;
+            result->payload = select_bits[q];
+        }
+        else
+        {
+            result->format = MATERIALIZED;
+            result->payload = position_buffer_finish(&select_data[q]);
+        }
+        arguments->results[q] = result;
+    }
+    free(select_data);
+    free(select_bits);
+    free(index);
+
+    pthread_mutex_lock(&lock);
+    // record the number of successful tasks completed
+    done++;
+    pthread_mutex_unlock(&lock);
+    // free arguments
+    free(arguments);
 }
+
+static bool merge_fetch(FetchOperator *merged, FetchOperator *fetch)
+{
+    if (strcmp(merged->positions, fetch->positions) != 0 || merged->num_columns + fetch->num_columns > MAX_FETCH_COLUMNS)
+        return false;
+    // a fetch that overwrites the positions ends the run, the next fetch reads its output
+    for (size_t c = 0; c < merged->num_columns; c++)
+    {
+        if (strcmp(merged->intermediates[c], merged->positions) == 0)
+            return false;
+    }
+    for (size_t c = 0; c < fetch->num_columns; c++)
+    {
+        merged->columns[merged->num_columns] = fetch->columns[c];
+        strcpy(merged->intermediates[merged->num_columns], fetch->intermediates[c]);
+        merged->num_columns++;
+    }
+    return true;
+}
+
+/*
+ * Runs the batched fetch at first together with the fetches of the same
+ * positions that directly follow it, as one multi-column fetch. Returns the
+ * index of the first query not run.
+ */
+static size_t execute_batch_fetch(DbOperator **batch_queries, size_t num_batch_queries, bool *grouped, size_t first, message *send_message)
+{
+    DbOperator *merged = batch_queries[first];
+    size_t next = first + 1;
+    for (; next < num_batch_queries; next++)
+    {
+        // ONE_COLUMN selects have already run
+        if (grouped[next])
+            continue;
+        if (batch_queries[next]->type != FETCH ||
+            !merge_fetch(&merged->operator_fields.fetch_operator, &batch_queries[next]->operator_fields.fetch_operator))
+            break;
+        free(batch_queries[next]);
+    }
+    execute_fetch(merged, send_message);
+    free(merged);
+    return next;
+}
+
 // TODO: check batch end
 void execute_batch_end(ClientContext *client_context, message *send_message)
 {
+    DbOperator **batch_queries = client_context->batch_queries;
+    size_t num_batch_queries = client_context->num_batch_queries;
+    // order ONE_COLUMN selects so that selects on the same column are adjacent
+    DbOperator **scan_queries = malloc(num_batch_queries * sizeof(DbOperator *));
+    Result **scan_results = malloc(num_batch_queries * sizeof(Result *));
+    bool *grouped = calloc(num_batch_queries, sizeof(bool));
+    size_t num_scan_queries = 0;
+    for (size_t i = 0; i < num_batch_queries; i++)
+    {
+        if (grouped[i] || batch_queries[i]->type != SELECT || batch_queries[i]->operator_fields.select_operator.select_type != ONE_COLUMN)
+            continue;
+        size_t group_start = num_scan_queries;
+        Column *column = batch_queries[i]->operator_fields.select_operator.column;
+        for (size_t j = i; j < num_batch_queries; j++)
+        {
+            if (!grouped[j] && batch_queries[j]->type == SELECT && batch_queries[j]->operator_fields.select_operator.select_type == ONE_COLUMN &&
+                batch_queries[j]->operator_fields.select_operator.column == column)
+            {
+                grouped[j] = true;
+                scan_queries[num_scan_queries++] = batch_queries[j];
+            }
+        }
+        // one shared scan task per column
+        thread_args *args = malloc(sizeof(thread_args));
+        args->queries = scan_queries + group_start;
+        args->results = scan_results + group_start;
+        args->num_queries = num_scan_queries - group_start;
+        while (tasks - done >= QUEUE)
+        {
+            sleep(0.01);
+        }
+        if (threadpool_add(pool, &batch_shared_scan, (void *)args, 0) == 0)
+        {
+            pthread_mutex_lock(&lock);
+            tasks++;
+            pthread_mutex_unlock(&lock);
+        }
+        else
+        {
+            cs165_log(stdout, "Start pool failed\n");
+            send_message->status = EXECUTION_ERROR;
+            return;
+        }
+    }
+    while (tasks > done)
+    {
+        sleep(0.01); // TODO: change sleep time
+    }
+    for (size_t q = 0; q < num_scan_queries; q++)
+    {
+        add_context(scan_results[q], client_context, scan_queries[q]->operator_fields.select_operator.intermediate);
+        free(scan_queries[q]);
+    }
+    // TWO_COLUMN selects and fetches may read the results above, so they run afterwards in queue order
+    for (size_t i = 0; i < num_batch_queries; i++)
+    {
+        if (grouped[i])
+            continue;
+        if (batch_queries[i]->type == FETCH)
+        {
+            // a fetch may read the selects queued before it
+            while (tasks > done)
+            {
+                sleep(0.01);
+            }
+            i = execute_batch_fetch(batch_queries, num_batch_queries, grouped, i, send_message) - 1;
+            continue;
+        }
+        // deferred operands are evaluated here, the workers only read materialized vectors
+        Result *operands[2] = {
+            lookup_variables(NULL, NULL, NULL, batch_queries[i]->operator_fields.select_operator.position_vector, client_context)->column_pointer.result,
+            lookup_variables(NULL, NULL, NULL, batch_queries[i]->operator_fields.select_operator.value_vector, client_context)->column_pointer.result};
+        evaluate_results(operands, 2);
+        thread_args *args = malloc(sizeof(thread_args));
+        args->query = batch_queries[i];
+        args->send_message = send_message;
+        while (tasks - done >= QUEUE)
+        {
+            sleep(0.01);
+        }
+        if (threadpool_add(pool, &batch_execute_select, (void *)args, 0) == 0)
+        {
+            pthread_mutex_lock(&lock);
+            tasks++;
+            pthread_mutex_unlock(&lock);
+        }
+        else
+        {
+            cs165_log(stdout, "Start pool failed\n");
+            send_message->status = EXECUTION_ERROR;
+            return;
+        }
+    }
     while (tasks > done)
     {
         sleep(0.01); // TODO: change sleep time
     }
+    free(scan_queries);
+    free(scan_results);
+    free(grouped);
     // At this point, destroy the thread pool, 0 for immediate_shutdown
     if (threadpool_destroy(pool, 0) != 0)
     {
@@ -1773,7 +2333,9 @@ void execute_batch_end(ClientContext *client_context, message *send_message)
     }
     client_context->batch_mode = false;
     pthread_mutex_destroy(&lock);
-    // free(client_context->batch_queries);
+    free(client_context->batch_queries);
+    client_context->batch_queries = NULL;
+    client_context->num_batch_queries = 0;
     send_message->status = OK_DONE;
 }
 
@@ -1819,9 +2381,9 @@ char *execute_DbOperator(DbOperator *query, message *send_message)
     {
         execute_load(query, send_message);
     }
-    else if (query && query->type == SELECT && query->context->batch_mode == true)
+    else if (query && (query->type == SELECT || query->type == FETCH) && query->context->batch_mode == true)
     {
-        execute_batch_select(query, send_message);
+        execute_batch_query(query, send_message);
     }
     else if (query && query->type == SELECT && query->context->batch_mode == false)
     {
@@ -1856,6 +2418,22 @@ char *execute_DbOperator(DbOperator *query, message *send_message)
     {
         execute_join(query, send_message);
     }
+    else if (query && query->type == FUSED_AGGREGATE)
+    {
+        execute_fused_aggregate(query, send_message);
+    }
+    else if (query && query->type == MULTI_SELECT)
+    {
+        execute_multi_select(query, send_message);
+    }
+    else if (query && query->type == POSITION_SET)
+    {
+        execute_position_set(query, send_message);
+    }
+    else if (query && query->type == GROUP_BY)
+    {
+        execute_group_by(query, send_message);
+    }
     return "165";
 }
 